@@ -19,7 +19,11 @@ int main() {
     navbar.add(Link("Home", "/"));
     navbar.add(Link("Docs", "/docs"));
     navbar.add(Link("GitHub", "https://github.com"));
-    app.navbar(navbar);
+
+    // The navbar, sidebar and cards are shared by the dark and light pages.
+    // Freezing renders each one once; both pages reuse the same node.
+    SharedComponent shared_navbar = freeze(std::move(navbar));
+    app.navbar(shared_navbar);
 
     // Sidebar content - session management
     SidebarSection sessions_section;
@@ -37,7 +41,8 @@ int main() {
     Sidebar sidebar;
     sidebar.add(sessions_section);
     sidebar.add(settings_section);
-    app.sidebar(sidebar);
+    SharedComponent shared_sidebar = freeze(std::move(sidebar));
+    app.sidebar(shared_sidebar);
 
     // Main chat area
     Card chat_card;
@@ -61,7 +66,8 @@ int main() {
     chat.add_message(ChatMessage("Hello! How can I help you today?").assistant());
 
     chat_card.add(chat);
-    app.add(chat_card);
+    SharedComponent shared_chat_card = freeze(std::move(chat_card));
+    app.add(shared_chat_card);
 
     // Additional info card
     Card info_card;
@@ -75,7 +81,8 @@ int main() {
     info_list.add(Text("3. Tokens stream in real-time via 'message' events"));
     info_list.add(Text("4. Connection closes on 'done' event"));
     info_card.add(info_list);
-    app.add(info_card);
+    SharedComponent shared_info_card = freeze(std::move(info_card));
+    app.add(shared_info_card);
 
     // Server response format card
     Card format_card;
@@ -98,7 +105,8 @@ int main() {
     format_card.add(Text("Each 'message' event should contain valid HTML that will be appended to the chat.")
         .secondary());
 
-    app.add(format_card);
+    SharedComponent shared_format_card = freeze(std::move(format_card));
+    app.add(shared_format_card);
 
     // HTML usage example
     Card html_card;
@@ -116,7 +124,8 @@ int main() {
     html_example.add(Text("</div>").classes("ew-code-line"));
     html_card.add(html_example);
 
-    app.add(html_card);
+    SharedComponent shared_html_card = freeze(std::move(html_card));
+    app.add(shared_html_card);
 
     page.add(app);
 
@@ -130,14 +139,14 @@ int main() {
               .light_mode()
               .with_sse();
 
-    // Need to rebuild app for light mode
+    // Same content, only the theme differs
     App light_app;
-    light_app.navbar(navbar);
-    light_app.sidebar(sidebar);
-    light_app.add(chat_card);
-    light_app.add(info_card);
-    light_app.add(format_card);
-    light_app.add(html_card);
+    light_app.navbar(shared_navbar);
+    light_app.sidebar(shared_sidebar);
+    light_app.add(shared_chat_card);
+    light_app.add(shared_info_card);
+    light_app.add(shared_format_card);
+    light_app.add(shared_html_card);
 
     light_page.add(light_app);
     light_page.render_to_file("chat-demo-light.html");
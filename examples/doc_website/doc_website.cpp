@@ -330,31 +330,41 @@ App create_doc_content() {
 }
 
 int main() {
+    // The three themes are independent pages, so render them in parallel
+    Site site;
+
     // Dark Mode - ideal for developer documentation
-    {
+    site.add("examples/doc_website/doc_website-dark.html", [] {
         Page page("ZeroJS Documentation - Dark Mode");
         page.dark_mode();
         page.add(create_doc_content());
-        page.render_to_file("examples/doc_website/doc_website-dark.html");
-        std::cout << "Generated doc_website-dark.html" << std::endl;
-    }
+        return page;
+    });
 
     // Light Mode - clean professional look
-    {
+    site.add("examples/doc_website/doc_website-light.html", [] {
         Page page("ZeroJS Documentation - Light Mode");
         page.light_mode();
         page.add(create_doc_content());
-        page.render_to_file("examples/doc_website/doc_website-light.html");
-        std::cout << "Generated doc_website-light.html" << std::endl;
-    }
+        return page;
+    });
 
     // Cream Mode - warm readable style
-    {
+    site.add("examples/doc_website/doc_website-cream.html", [] {
         Page page("ZeroJS Documentation - Cream Mode");
         page.cream_mode();
         page.add(create_doc_content());
-        page.render_to_file("examples/doc_website/doc_website-cream.html");
-        std::cout << "Generated doc_website-cream.html" << std::endl;
+        return page;
+    });
+
+    SiteReport report = site.build();
+    for (const PageTiming& page : report.pages) {
+        if (!page.result) {
+            std::cerr << page.path << ": " << page.result.message() << std::endl;
+            continue;
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(page.build + page.write).count();
+        std::cout << "Generated " << page.path << " (" << us << " us)" << std::endl;
     }
 
     std::cout << "\nOpen any of the HTML files in your browser:" << std::endl;
@@ -362,5 +372,5 @@ int main() {
     std::cout << "  - doc_website-light.html (Clean professional theme)" << std::endl;
     std::cout << "  - doc_website-cream.html (Warm readable theme)" << std::endl;
 
-    return 0;
+    return report.failed() == 0 ? 0 : 1;
 }
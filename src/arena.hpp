@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zero_js
+{
+
+// ============================================================================
+// Arena Allocation
+// ============================================================================
+
+// Bump allocator for component trees. Nodes built while an ArenaScope is
+// active are placed contiguously in large blocks instead of one heap
+// allocation each, and the blocks are released together once the last node
+// that lives in them is gone. Individual deallocations are no-ops, so
+// space is reclaimed only with the whole arena. Nodes are still destroyed
+// one by one; only their allocations are pooled.
+//
+// An Arena is a cheap handle: copies share the same blocks. Allocation is not
+// synchronised, so build a tree from one thread at a time.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 64 * 1024) : state_(std::make_shared<State>()) {
+        state_->block_size = block_size;
+    }
+
+    void* allocate(size_t size, size_t align) { return allocate(*state_, size, align); }
+
+    size_t bytes_used() const { return state_->used; }
+    size_t block_count() const { return state_->blocks.size(); }
+
+private:
+    template<typename T> friend class ArenaAllocator;
+
+    struct State {
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* cursor = nullptr;
+        char* end = nullptr;
+        size_t block_size = 0;
+        size_t used = 0;
+    };
+
+    static char* align_ptr(char* p, size_t align) {
+        uintptr_t v = reinterpret_cast<uintptr_t>(p);
+        return p + ((align - v % align) % align);
+    }
+
+    static void* allocate(State& s, size_t size, size_t align) {
+        char* p = s.cursor ? align_ptr(s.cursor, align) : nullptr;
+        if (p == nullptr || p + size > s.end) {
+            if (size + align > s.block_size) {
+                // Oversized request gets a block of its own
+                s.blocks.emplace_back(new char[size + align]);
+                s.used += size;
+                return align_ptr(s.blocks.back().get(), align);
+            }
+            s.blocks.emplace_back(new char[s.block_size]);
+            s.cursor = s.blocks.back().get();
+            s.end = s.cursor + s.block_size;
+            p = align_ptr(s.cursor, align);
+        }
+        s.cursor = p + size;
+        s.used += size;
+        return p;
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+// std::allocator-compatible adaptor, used with std::allocate_shared so the
+// node and its control block share one arena slot
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(const Arena& arena) : state_(arena.state_) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : state_(other.state_) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(Arena::allocate(*state_, n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return state_ == other.state_; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return state_ != other.state_; }
+
+private:
+    template<typename U> friend class ArenaAllocator;
+    std::shared_ptr<Arena::State> state_;
+};
+
+// The arena make_component allocates from on this thread, if any
+inline Arena*& current_arena() {
+    thread_local Arena* arena = nullptr;
+    return arena;
+}
+
+// Routes every component built on this thread into the arena for the
+// lifetime of the scope. Scopes nest.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : previous_(current_arena()) { current_arena() = &arena; }
+    ~ArenaScope() { current_arena() = previous_; }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* previous_;
+};
+
+}
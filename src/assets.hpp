@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "styles.hpp"
+#include "htmx.hpp"
+#include "output.hpp"
+#include "compress.hpp"
+
+namespace zero_js
+{
+
+// ============================================================================
+// Content-Hashed Assets
+// ============================================================================
+
+// 64-bit FNV-1a. Not cryptographic; only used to tell versions apart. Pass
+// the previous result as hash to continue over data in pieces.
+inline uint64_t fnv1a64(std::string_view data, uint64_t hash = 0xcbf29ce484222325ull) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+inline std::string hash_hex(uint64_t hash) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) out[i] = digits[hash & 0xf];
+    return out;
+}
+
+// A file whose name carries a hash of its content ("<stem>.<hash>.<ext>"),
+// so it can be served with immutable cache headers: a new version always
+// has a new name. Copies share the content.
+struct Asset {
+    std::string name;
+    std::shared_ptr<const std::string> content;
+};
+
+inline std::string asset_name(std::string_view stem, std::string_view ext, std::string_view content) {
+    std::string name;
+    name.reserve(stem.size() + ext.size() + 18);
+    name.append(stem).append(".").append(hash_hex(fnv1a64(content))).append(".").append(ext);
+    return name;
+}
+
+inline Asset make_asset(std::string_view stem, std::string_view ext, std::string content) {
+    Asset asset;
+    asset.name = asset_name(stem, ext, content);
+    asset.content = std::make_shared<const std::string>(std::move(content));
+    return asset;
+}
+
+namespace asset_detail
+{
+    template<bool Minified, bool FontImport>
+    const Asset& all_themes_stylesheet_asset() {
+        static const Asset asset = make_asset("zero_js-themes", "css",
+                                              std::string(cached_all_themes_css(Minified, FontImport)));
+        return asset;
+    }
+}
+
+// generate_all_themes_css() as zero_js-themes.<hash>.css
+inline const Asset& all_themes_stylesheet_asset(bool minified = false, bool font_import = true) {
+    if (font_import) {
+        return minified ? asset_detail::all_themes_stylesheet_asset<true, true>() : asset_detail::all_themes_stylesheet_asset<false, true>();
+    }
+    return minified ? asset_detail::all_themes_stylesheet_asset<true, false>() : asset_detail::all_themes_stylesheet_asset<false, false>();
+}
+
+// The bundled htmx as htmx.<hash>.js, built once per process
+inline const Asset& htmx_asset() {
+    static const Asset asset = make_asset("htmx", "js", std::string(htmx_script_view()));
+    return asset;
+}
+
+// The bundled SSE extension as htmx-sse.<hash>.js
+inline const Asset& htmx_sse_asset() {
+    static const Asset asset = make_asset("htmx-sse", "js", std::string(htmx_sse_extension_view()));
+    return asset;
+}
+
+// The same versions on unpkg.com
+inline constexpr std::string_view htmx_cdn_url = "https://unpkg.com/htmx.org@1.9.10";
+inline constexpr std::string_view htmx_sse_cdn_url = "https://unpkg.com/htmx-ext-sse@2.2.1/sse.js";
+
+// Asset paths written during one multi-page build, so a stylesheet or
+// script that many pages link is written once even when the pages are
+// written from several threads. Thread-safe.
+class AssetLog {
+public:
+    // Runs write() the first time path comes up and returns its result.
+    // Later calls for the same path wait until that write is done and
+    // return the same result, so no page goes ahead of an asset it links.
+    template<typename Write>
+    WriteResult once(const std::string& path, Write&& write) {
+        std::promise<WriteResult> promise;
+        std::shared_future<WriteResult> result;
+        bool first = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto [it, inserted] = results_.try_emplace(path);
+            if (inserted) {
+                it->second = promise.get_future().share();
+                first = true;
+            }
+            result = it->second;
+        }
+        if (!first) return result.get();
+        try {
+            WriteResult written = write();
+            promise.set_value(written);
+            return written;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<WriteResult>> results_;
+};
+
+inline AssetLog*& current_asset_log() {
+    thread_local AssetLog* log = nullptr;
+    return log;
+}
+
+// Makes write_asset() on this thread write each asset once per log, for
+// the lifetime of the scope. Scopes nest.
+class AssetLogScope {
+public:
+    explicit AssetLogScope(AssetLog& log) : previous_(current_asset_log()) { current_asset_log() = &log; }
+    ~AssetLogScope() { current_asset_log() = previous_; }
+
+    AssetLogScope(const AssetLogScope&) = delete;
+    AssetLogScope& operator=(const AssetLogScope&) = delete;
+
+private:
+    AssetLog* previous_;
+};
+
+// Writes the asset into dir (which must exist) unless a file of that name is
+// already there; the hashed name means it would hold the same bytes. Under
+// an AssetLogScope each asset is written once, and every other caller gets
+// the result of that write. Like pages, assets are renamed into place once
+// complete, so an existing file is never a partial one. Precompressed
+// siblings that are missing are added.
+//
+// A batch is not used: assets are synced and in place before this returns,
+// so a page committed later never links one that failed. A site has only a
+// handful of them.
+inline WriteResult write_asset(const std::string& dir, const Asset& asset, const WriteOptions& given) {
+    std::string path = dir.empty() ? asset.name : dir + "/" + asset.name;
+    WriteOptions options;
+    options.sync = given.batch ? SyncPolicy::EachFile : given.sync;
+    options.precompress = given.precompress;
+    auto write = [&path, &asset, &options] {
+        std::string_view content = *asset.content;
+        if (::access(path.c_str(), F_OK) != 0) {
+            WriteResult result = write_file_atomic(path, content, options);
+            if (!result) return result;
+        }
+        return write_precompressed(path, content, options, true);
+    };
+    AssetLog* log = current_asset_log();
+    return log ? log->once(path, write) : write();
+}
+
+inline WriteResult write_asset(const std::string& dir, const Asset& asset, SyncPolicy policy = SyncPolicy::None) {
+    WriteOptions options;
+    options.sync = policy;
+    return write_asset(dir, asset, options);
+}
+
+inline WriteResult write_asset(const std::string& dir, const Asset& asset, SyncBatch& batch) {
+    WriteOptions options;
+    options.batch = &batch;
+    return write_asset(dir, asset, options);
+}
+
+}
@@ -50,63 +50,71 @@ public:
 
     Chart() = default;
 
-    Chart& width(int w) { width_ = w; return *this; }
-    Chart& height(int h) { height_ = h; return *this; }
-    Chart& title(const std::string& t) { title_ = t; return *this; }
-    Chart& showGrid(bool show = true) { show_grid_ = show; return *this; }
-    Chart& showLegend(bool show = true) { show_legend_ = show; return *this; }
-    Chart& addSeries(const ChartSeries& series) { series_.push_back(series); return *this; }
-    Chart& id(const std::string& i) { id_ = i; return *this; }
-    Chart& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        return generateSVG("<text x='50%' y='50%' text-anchor='middle' fill='var(--ew-text-muted)'>Chart implementation required</text>");
-    }
-
-protected:
-    std::string generateSVG(const std::string& chart_content) const {
-        std::ostringstream svg;
-        svg << "<div class=\"ew-chart-container";
-        if (!classes_.empty()) svg << " " << classes_;
-        svg << "\"" << render_attributes() << ">";
+    Chart& width(int w) { width_ = w; touch(); return *this; }
+    Chart& height(int h) { height_ = h; touch(); return *this; }
+    Chart& title(const std::string& t) { title_ = t; touch(); return *this; }
+    Chart& showGrid(bool show = true) { show_grid_ = show; touch(); return *this; }
+    Chart& showLegend(bool show = true) { show_legend_ = show; touch(); return *this; }
+    Chart& addSeries(const ChartSeries& series) { series_.push_back(series); touch(); return *this; }
+    Chart& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Chart& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-chart-container";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
 
         if (!title_.empty()) {
-            svg << "<div class=\"ew-chart-title\">" << title_ << "</div>";
+            out << "<div class=\"ew-chart-title\">" << title_ << "</div>";
         }
 
-        svg << "<svg width=\"" << width_ << "\" height=\"" << height_
+        out << "<svg width=\"" << width_ << "\" height=\"" << height_
             << "\" viewBox=\"0 0 " << width_ << " " << height_
             << "\" class=\"ew-chart\">";
 
         // Background (only border, no fill to avoid covering chart)
-        svg << "<rect width=\"100%\" height=\"100%\" fill=\"transparent\" stroke=\"var(--ew-border)\" stroke-width=\"1\" rx=\"4\"/>";
-
-        // Chart content (implemented by subclasses)
-        svg << chart_content;
+        out << "<rect width=\"100%\" height=\"100%\" fill=\"transparent\" stroke=\"var(--ew-border)\" stroke-width=\"1\" rx=\"4\"/>";
+
+        // Chart content (implemented by subclasses), formatted through a
+        // fresh ostream so number formatting state never leaks between charts
+        {
+            SinkStreamBuf buf(out);
+            std::ostream content(&buf);
+            renderContent(content);
+        }
 
-        svg << "</svg>";
+        out << "</svg>";
 
         if (show_legend_ && !series_.empty()) {
-            svg << generateLegend();
+            renderLegend(out);
         }
 
-        svg << "</div>";
-        return svg.str();
+        out << "</div>";
+    }
+
+    bool expensive_to_render() const override { return true; }
+
+protected:
+    virtual void renderContent(std::ostream& content) const {
+        content << "<text x='50%' y='50%' text-anchor='middle' fill='var(--ew-text-muted)'>Chart implementation required</text>";
     }
 
-    std::string generateLegend() const {
-        std::ostringstream legend;
-        legend << "<div class=\"ew-chart-legend\">";
+    void renderLegend(Sink& out) const {
+        out << "<div class=\"ew-chart-legend\">";
         for (const auto& series : series_) {
             if (!series.name.empty()) {
-                legend << "<div class=\"ew-chart-legend-item\">"
-                       << "<div class=\"ew-chart-legend-color\" style=\"background-color: " << (series.color.empty() ? "var(--ew-primary)" : series.color) << "\"></div>"
-                       << "<span>" << series.name << "</span>"
-                       << "</div>";
+                out << "<div class=\"ew-chart-legend-item\">"
+                    << "<div class=\"ew-chart-legend-color\" style=\"background-color: ";
+                if (series.color.empty()) out << "var(--ew-primary)";
+                else out << series.color;
+                out << "\"></div>"
+                    << "<span>" << series.name << "</span>"
+                    << "</div>";
             }
         }
-        legend << "</div>";
-        return legend.str();
+        out << "</div>";
     }
 
     std::pair<double, double> findDataRange() const {
@@ -204,38 +212,34 @@ public:
 
     LineChart() = default;
 
-    LineChart& smoothLines(bool smooth = true) { smooth_lines_ = smooth; return *this; }
-    LineChart& showPoints(bool show = true) { show_points_ = show; return *this; }
-    LineChart& pointRadius(int radius) { point_radius_ = radius; return *this; }
+    LineChart& smoothLines(bool smooth = true) { smooth_lines_ = smooth; touch(); return *this; }
+    LineChart& showPoints(bool show = true) { show_points_ = show; touch(); return *this; }
+    LineChart& pointRadius(int radius) { point_radius_ = radius; touch(); return *this; }
 
-    std::string render() const override {
+protected:
+    void renderContent(std::ostream& content) const override {
         auto [min_x, max_x] = findDataRange();
         auto [min_y, max_y] = findYRange();
 
-        std::ostringstream content;
-
         // Grid lines
         if (show_grid_) {
-            content << generateGrid(min_x, max_x, min_y, max_y);
+            generateGrid(content, min_x, max_x, min_y, max_y);
         }
 
         // Axes
-        content << generateAxes(min_x, max_x, min_y, max_y);
+        generateAxes(content, min_x, max_x, min_y, max_y);
 
         // Data lines
         for (size_t i = 0; i < series_.size(); ++i) {
             const auto& series = series_[i];
             if (!series.data.empty()) {
-                content << generateLine(series, min_x, max_x, min_y, max_y, i);
+                generateLine(content, series, min_x, max_x, min_y, max_y, i);
             }
         }
-
-        return generateSVG(content.str());
     }
 
 private:
-    std::string generateGrid(double min_x, double max_x, double min_y, double max_y) const {
-        std::ostringstream grid;
+    void generateGrid(std::ostream& grid, double min_x, double max_x, double min_y, double max_y) const {
         const int margin = 60;
         double chart_width = width_ - 2 * margin;
         double chart_height = height_ - 2 * margin;
@@ -255,12 +259,9 @@ private:
                  << "\" x2=\"" << width_ - margin << "\" y2=\"" << y
                  << "\" stroke=\"var(--ew-border)\" stroke-width=\"0.5\" opacity=\"0.3\"/>";
         }
-
-        return grid.str();
     }
 
-    std::string generateAxes(double min_x, double max_x, double min_y, double max_y) const {
-        std::ostringstream axes;
+    void generateAxes(std::ostream& axes, double min_x, double max_x, double min_y, double max_y) const {
         const int margin = 60;
         double chart_width = width_ - 2 * margin;
         double chart_height = height_ - 2 * margin;
@@ -309,15 +310,12 @@ private:
                  << "\" text-anchor=\"middle\" fill=\"var(--ew-text)\" font-size=\"11\">"
                  << label.str() << "</text>";
         }
-
-        return axes.str();
     }
 
-    std::string generateLine(const ChartSeries& series, double min_x, double max_x, double min_y, double max_y, size_t series_index) const {
-        std::ostringstream line;
+    void generateLine(std::ostream& line, const ChartSeries& series, double min_x, double max_x, double min_y, double max_y, size_t series_index) const {
         std::string color = series.color.empty() ? "var(--ew-primary)" : series.color;
 
-        if (series.data.size() < 2) return "";
+        if (series.data.size() < 2) return;
 
         // Generate path
         std::ostringstream path_data;
@@ -350,8 +348,6 @@ private:
                      << "\" fill=\"" << color << "\"/>";
             }
         }
-
-        return line.str();
     }
 };
 
@@ -367,38 +363,34 @@ public:
 
     BarChart() = default;
 
-    BarChart& horizontal(bool h = true) { horizontal_ = h; return *this; }
-    BarChart& barWidth(int w) { bar_width_ = w; return *this; }
-    BarChart& barSpacing(int s) { bar_spacing_ = s; return *this; }
+    BarChart& horizontal(bool h = true) { horizontal_ = h; touch(); return *this; }
+    BarChart& barWidth(int w) { bar_width_ = w; touch(); return *this; }
+    BarChart& barSpacing(int s) { bar_spacing_ = s; touch(); return *this; }
 
-    std::string render() const override {
+protected:
+    void renderContent(std::ostream& content) const override {
         auto [min_x, max_x] = findDataRange();
         auto [min_y, max_y] = findYRange();
 
-        std::ostringstream content;
-
         // Grid lines
         if (show_grid_) {
-            content << generateGrid(min_x, max_x, min_y, max_y);
+            generateGrid(content, min_x, max_x, min_y, max_y);
         }
 
         // Axes
-        content << generateAxes(min_x, max_x, min_y, max_y);
+        generateAxes(content, min_x, max_x, min_y, max_y);
 
         // Bars
         for (size_t i = 0; i < series_.size(); ++i) {
             const auto& series = series_[i];
             if (!series.data.empty()) {
-                content << generateBars(series, min_x, max_x, min_y, max_y, i);
+                generateBars(content, series, min_x, max_x, min_y, max_y, i);
             }
         }
-
-        return generateSVG(content.str());
     }
 
 private:
-    std::string generateGrid(double min_x, double max_x, double min_y, double max_y) const {
-        std::ostringstream grid;
+    void generateGrid(std::ostream& grid, double min_x, double max_x, double min_y, double max_y) const {
         const int margin = 60;
 
         // Horizontal grid lines
@@ -408,12 +400,9 @@ private:
                  << "\" x2=\"" << width_ - margin << "\" y2=\"" << y
                  << "\" stroke=\"var(--ew-border)\" stroke-width=\"0.5\" opacity=\"0.3\"/>";
         }
-
-        return grid.str();
     }
 
-    std::string generateAxes(double min_x, double max_x, double min_y, double max_y) const {
-        std::ostringstream axes;
+    void generateAxes(std::ostream& axes, double min_x, double max_x, double min_y, double max_y) const {
         const int margin = 60;
         double chart_width = width_ - 2 * margin;
         double chart_height = height_ - 2 * margin;
@@ -444,12 +433,9 @@ private:
                  << "\" text-anchor=\"end\" fill=\"var(--ew-text)\" font-size=\"11\">"
                  << label.str() << "</text>";
         }
-
-        return axes.str();
     }
 
-    std::string generateBars(const ChartSeries& series, double min_x, double max_x, double min_y, double max_y, size_t series_index) const {
-        std::ostringstream bars;
+    void generateBars(std::ostream& bars, const ChartSeries& series, double min_x, double max_x, double min_y, double max_y, size_t series_index) const {
         std::string color = series.color.empty() ? "var(--ew-primary)" : series.color;
 
         const int margin = 60;
@@ -480,8 +466,6 @@ private:
                  << "\" text-anchor=\"middle\" fill=\"var(--ew-text)\" font-size=\"11\" font-weight=\"bold\">"
                  << value_label.str() << "</text>";
         }
-
-        return bars.str();
     }
 };
 
@@ -496,8 +480,8 @@ public:
 
     PieChart() = default;
 
-    PieChart& showLabels(bool show = true) { show_labels_ = show; return *this; }
-    PieChart& innerRadius(int radius) { inner_radius_ = radius; return *this; }
+    PieChart& showLabels(bool show = true) { show_labels_ = show; touch(); return *this; }
+    PieChart& innerRadius(int radius) { inner_radius_ = radius; touch(); return *this; }
 
     // Override addSeries to handle pie chart legend properly
     PieChart& addSeries(const ChartSeries& series) {
@@ -510,13 +494,13 @@ public:
             ChartSeries individual_series(name, {point}, color);
             series_.push_back(individual_series);
         }
+        touch();
         return *this;
     }
 
-    std::string render() const override {
-        std::ostringstream content;
-
-        if (series_.empty()) return generateSVG("");
+protected:
+    void renderContent(std::ostream& content) const override {
+        if (series_.empty()) return;
 
         // Collect all data points from all series
         std::vector<DataPoint> all_data;
@@ -526,7 +510,7 @@ public:
             }
         }
 
-        if (all_data.empty()) return generateSVG("");
+        if (all_data.empty()) return;
 
         double total = 0;
         for (const auto& point : all_data) {
@@ -587,8 +571,6 @@ public:
                     << "\" r=\"" << inner_radius_
                     << "\" fill=\"var(--ew-bg-card)\"/>";
         }
-
-        return generateSVG(content.str());
     }
 
 private:
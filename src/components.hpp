@@ -1,9 +1,20 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <memory>
-#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include "sink.hpp"
+#include "arena.hpp"
+#include "thread_pool.hpp"
+#include "themes.hpp"
+#include "fonts.hpp"
 
 namespace zero_js
 { 
@@ -11,101 +22,513 @@ namespace zero_js
 // Forward declarations
 class Component;
 using ComponentPtr = std::shared_ptr<Component>;
+// Immutable subtree that any number of pages can reference (see freeze())
+using SharedComponent = std::shared_ptr<const Component>;
 
-// Helper to create component pointers
+template<typename T> struct is_shared_ptr : std::false_type {};
+template<typename T> struct is_shared_ptr<std::shared_ptr<T>> : std::true_type {};
+
+// Helper to create component pointers. Inside an ArenaScope the node is
+// placed in that arena instead of getting its own heap allocation. Passing a
+// std::shared_ptr adds that node itself rather than a copy, so the caller
+// keeps a handle to update it later (e.g. a live Stat). A SharedComponent is
+// added the same way; it is only ever rendered, never modified.
 template<typename T>
 ComponentPtr make_component(T&& component) {
-    return std::make_shared<std::decay_t<T>>(std::forward<T>(component));
+    using U = std::decay_t<T>;
+    if constexpr (is_shared_ptr<U>::value) {
+        using Node = std::remove_const_t<typename U::element_type>;
+        return std::const_pointer_cast<Node>(std::forward<T>(component));
+    } else {
+        if (Arena* arena = current_arena()) {
+            return std::allocate_shared<U>(ArenaAllocator<U>(*arena), std::forward<T>(component));
+        }
+        return std::make_shared<U>(std::forward<T>(component));
+    }
 }
 
+// HTML attributes shared by all components. Listed in the order
+// render_attributes() emits them; Classes is rendered by each component
+// inside its own class="..." attribute.
+enum class Attr : unsigned char {
+    Id,
+    HxGet,
+    HxPost,
+    HxTarget,
+    HxSwap,
+    HxTrigger,
+    HxExt,
+    HxVals,
+    SseConnect,
+    SseSwap,
+    SseClose,
+    Classes
+};
+
+// Sparse attribute storage. Most nodes set one or two attributes (often
+// none), so only the ones present are stored, kept sorted by Attr. An empty
+// list is a single empty vector rather than a dozen std::string members.
+class AttrList {
+public:
+    const std::string& get(Attr a) const {
+        static const std::string empty;
+        for (const auto& entry : entries_) {
+            if (entry.first == a) return entry.second;
+            if (entry.first > a) break;
+        }
+        return empty;
+    }
+
+    void set(Attr a, std::string value) {
+        auto it = find(a);
+        if (value.empty()) {
+            if (it != entries_.end() && it->first == a) entries_.erase(it);
+        } else if (it != entries_.end() && it->first == a) {
+            it->second = std::move(value);
+        } else {
+            entries_.insert(it, {a, std::move(value)});
+        }
+    }
+
+    void append(Attr a, std::string_view value) {
+        auto it = find(a);
+        if (it != entries_.end() && it->first == a) it->second.append(value);
+        else entries_.insert(it, {a, std::string(value)});
+    }
+
+    using Entry = std::pair<Attr, std::string>;
+    std::vector<Entry>::const_iterator begin() const { return entries_.begin(); }
+    std::vector<Entry>::const_iterator end() const { return entries_.end(); }
+    bool empty() const { return entries_.empty(); }
+
+private:
+    std::vector<Entry>::iterator find(Attr a) {
+        auto it = entries_.begin();
+        while (it != entries_.end() && it->first < a) ++it;
+        return it;
+    }
+
+    std::vector<Entry> entries_;
+};
+
+struct RenderCache;
+
+// The caches a node's markup is part of, so a change can mark them stale
+// without anyone walking the tree. A node links itself to the nearest
+// cached ancestor each time that ancestor renders it; usually that is one
+// cache, more if the node sits under several. Not copied with the node:
+// a copy is linked wherever it is rendered.
+class CacheLinks {
+public:
+    CacheLinks() = default;
+    CacheLinks(const CacheLinks&) {}
+    CacheLinks& operator=(const CacheLinks&) { return *this; }
+    CacheLinks(CacheLinks&&) = default;
+    CacheLinks& operator=(CacheLinks&&) = default;
+
+    std::vector<std::weak_ptr<RenderCache>> caches;
+};
+
+// Guards every CacheLinks. Taken when a cache fill links a node, and when a
+// change walks up from a node that has links.
+inline std::mutex& cache_link_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Rendered bytes of a cached subtree. Not copied with the component: a copy
+// starts with an empty cache and fills it on its first render.
+struct RenderCache {
+    std::mutex mutex;
+    std::string bytes;
+    std::atomic<bool> dirty{false};   // something inside changed since bytes were filled
+    bool valid = false;
+    bool frozen = false;    // set once by freeze(), before the node is shared
+    CacheLinks up;          // the caches this one's owner is part of
+};
+
+class RenderCacheSlot {
+public:
+    RenderCacheSlot() = default;
+    RenderCacheSlot(const RenderCacheSlot& other) { if (other.cache_) enable(); }
+    RenderCacheSlot& operator=(const RenderCacheSlot& other) {
+        if (this != &other) {
+            cache_.reset();
+            if (other.cache_) enable();
+        }
+        return *this;
+    }
+    RenderCacheSlot(RenderCacheSlot&&) = default;
+    RenderCacheSlot& operator=(RenderCacheSlot&&) = default;
+
+    void enable() { if (!cache_) cache_ = std::make_shared<RenderCache>(); }
+    void disable() { cache_.reset(); }
+    RenderCache* get() const { return cache_.get(); }
+    const std::shared_ptr<RenderCache>& shared() const { return cache_; }
+
+private:
+    std::shared_ptr<RenderCache> cache_;
+};
+
+// The cache being filled on this thread, which nodes rendered now link to
+inline const std::shared_ptr<RenderCache>*& filling_cache() {
+    thread_local const std::shared_ptr<RenderCache>* cache = nullptr;
+    return cache;
+}
+
+class CacheFillScope {
+public:
+    explicit CacheFillScope(const std::shared_ptr<RenderCache>* cache) : previous_(filling_cache()) {
+        filling_cache() = cache;
+    }
+    ~CacheFillScope() { filling_cache() = previous_; }
+
+    CacheFillScope(const CacheFillScope&) = delete;
+    CacheFillScope& operator=(const CacheFillScope&) = delete;
+
+private:
+    const std::shared_ptr<RenderCache>* previous_;
+};
+
+// Parallel render settings, active on a thread while a page renders in
+// parallel mode (see Page::parallel). Child lists with at least
+// min_children entries, or with an expensive child such as a chart, are
+// rendered as separate tasks and concatenated in order.
+struct ParallelRender {
+    ThreadPool* pool = nullptr;
+    size_t min_children = 8;
+};
+
+inline const ParallelRender*& parallel_render() {
+    thread_local const ParallelRender* settings = nullptr;
+    return settings;
+}
+
+class ParallelRenderScope {
+public:
+    explicit ParallelRenderScope(const ParallelRender* settings) : previous_(parallel_render()) {
+        parallel_render() = settings;
+    }
+    ~ParallelRenderScope() { parallel_render() = previous_; }
+
+    ParallelRenderScope(const ParallelRenderScope&) = delete;
+    ParallelRenderScope& operator=(const ParallelRenderScope&) = delete;
+
+private:
+    const ParallelRender* previous_;
+};
+
+// Client-side scripts a node's markup relies on
+struct ScriptNeeds {
+    bool htmx = false;
+    bool sse = false;
+};
+
 // Base component class
 class Component {
 public:
     virtual ~Component() = default;
-    virtual std::string render() const = 0;
-
-    std::string id_;
-    std::string classes_;
-    std::string hx_get_;
-    std::string hx_post_;
-    std::string hx_target_;
-    std::string hx_swap_;
-    std::string hx_trigger_;
-    std::string hx_ext_;
-    std::string hx_vals_;
-    std::string sse_connect_;
-    std::string sse_swap_;
-    std::string sse_close_;
+
+    // Streaming render: append this component's markup to the sink
+    virtual void render_to(Sink& out) const = 0;
+
+    // Convenience wrapper that renders into a fresh string
+    virtual std::string render() const {
+        StringSink out;
+        render_to(out);
+        return std::move(out.str());
+    }
+
+    // Exact byte length render() would produce, without building the string
+    size_t measure() const {
+        CountingSink out;
+        render_to(out);
+        return out.size();
+    }
+
+    const std::string& attr(Attr a) const { return attrs_.get(a); }
+    void set_attr(Attr a, std::string value) { attrs_.set(a, std::move(value)); touch(); }
+    void append_attr(Attr a, std::string_view value) { attrs_.append(a, value); touch(); }
+
+    // Direct children, for passes that walk the tree without rendering it.
+    // Containers override this; leaves have none.
+    virtual void for_each_child(const std::function<void(const Component&)>&) const {}
+
+    // Marks this node as changed, and with it every cached subtree it is
+    // part of. Setters call it; call it yourself after editing a public
+    // member (e.g. children_) directly. The walk up stops at caches that are
+    // already stale, so a burst of edits costs about one step each.
+    void touch() {
+        RenderCache* own = cache_.get();
+        if (own && (own->frozen || own->dirty.exchange(true))) return;
+        CacheLinks& links = own ? own->up : up_;
+        // Links change only while this node renders, never during an edit
+        if (!links.caches.empty()) invalidate(links);
+    }
+
+    bool is_cached() const { return cache_.get() != nullptr; }
+    bool is_frozen() const { return cache_.get() && cache_.get()->frozen; }
+
+    // Hint for parallel rendering: worth a task of its own even in a short
+    // child list
+    virtual bool expensive_to_render() const { return false; }
+
+    // Scripts this node's own markup needs, judged from its hx-get, hx-post,
+    // hx-trigger and sse-connect attributes. Children are asked separately;
+    // components that write such attributes themselves override it.
+    virtual ScriptNeeds scripts_needed() const {
+        ScriptNeeds needs;
+        needs.sse = !attrs_.get(Attr::SseConnect).empty();
+        needs.htmx = needs.sse || !attrs_.get(Attr::HxGet).empty() || !attrs_.get(Attr::HxPost).empty() ||
+                     !attrs_.get(Attr::HxTrigger).empty();
+        return needs;
+    }
 
 protected:
-    std::string render_attributes() const {
-        std::ostringstream attrs;
-        if (!id_.empty()) attrs << " id=\"" << id_ << "\"";
-        if (!hx_get_.empty()) attrs << " hx-get=\"" << hx_get_ << "\"";
-        if (!hx_post_.empty()) attrs << " hx-post=\"" << hx_post_ << "\"";
-        if (!hx_target_.empty()) attrs << " hx-target=\"" << hx_target_ << "\"";
-        if (!hx_swap_.empty()) attrs << " hx-swap=\"" << hx_swap_ << "\"";
-        if (!hx_trigger_.empty()) attrs << " hx-trigger=\"" << hx_trigger_ << "\"";
-        if (!hx_ext_.empty()) attrs << " hx-ext=\"" << hx_ext_ << "\"";
-        if (!hx_vals_.empty()) attrs << " hx-vals='" << hx_vals_ << "'";
-        if (!sse_connect_.empty()) attrs << " sse-connect=\"" << sse_connect_ << "\"";
-        if (!sse_swap_.empty()) attrs << " sse-swap=\"" << sse_swap_ << "\"";
-        if (!sse_close_.empty()) attrs << " sse-close=\"" << sse_close_ << "\"";
-        return attrs.str();
-    }
-
-    std::string render_children(const std::vector<ComponentPtr>& children) const {
-        std::ostringstream html;
+    AttrList attrs_;
+    RenderCacheSlot cache_;
+    mutable CacheLinks up_;   // while the node is not cached itself
+
+    // Keep this subtree's rendered bytes and splice them in on later renders
+    // until something inside it changes. Containers expose it as cached().
+    void enable_cache(bool on) {
+        if (on == is_cached()) return;
+        if (on) {
+            cache_.enable();
+            cache_.get()->up = std::move(up_);
+        } else {
+            up_ = std::move(cache_.get()->up);
+            cache_.disable();
+        }
+    }
+
+    // A valid cache nothing has marked stale is spliced in without looking
+    // at the subtree. The lock is not held while rendering, so a node
+    // reached twice during a parallel render (or from the thread helping
+    // with its own subtasks) at worst renders twice.
+    void render_cached(Sink& out) const {
+        const std::shared_ptr<RenderCache>& shared = cache_.shared();
+        RenderCache& cache = *shared;
+        if (cache.frozen) {
+            // Immutable since freeze(): no lock, and the bytes are referenced
+            out << cache.bytes;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            if (cache.valid && !cache.dirty.load(std::memory_order_acquire)) {
+                out << std::string_view(cache.bytes);
+                return;
+            }
+            // A change made while rendering marks it stale again
+            cache.dirty.store(false, std::memory_order_release);
+            cache.valid = false;
+        }
+        std::string bytes;
+        {
+            CacheFillScope scope(&shared);
+            StringSink buffer(bytes);
+            render_to(buffer);
+        }
+        out << std::string_view(bytes);
+
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.bytes = std::move(bytes);
+        cache.valid = true;
+    }
+
+    // Renders a child, reusing its cached bytes when it has them, and links
+    // it to the cache being filled, if any
+    static void render_child(const Component& child, Sink& out) {
+        if (const std::shared_ptr<RenderCache>* fill = filling_cache()) child.link(*fill);
+        if (child.is_cached()) child.render_cached(out);
+        else child.render_to(out);
+    }
+
+    static void visit(const std::vector<ComponentPtr>& children, const std::function<void(const Component&)>& fn) {
+        for (const auto& child : children) fn(*child);
+    }
+
+    void render_attributes(Sink& out) const {
+        // Opening text per attribute, indexed by Attr; hx-vals holds JSON so
+        // it is single-quoted
+        static constexpr std::string_view open[] = {
+            " id=\"", " hx-get=\"", " hx-post=\"", " hx-target=\"", " hx-swap=\"",
+            " hx-trigger=\"", " hx-ext=\"", " hx-vals='", " sse-connect=\"",
+            " sse-swap=\"", " sse-close=\""
+        };
+        for (const auto& [a, value] : attrs_) {
+            if (a == Attr::Classes) continue;
+            out << open[static_cast<int>(a)] << value << (a == Attr::HxVals ? '\'' : '"');
+        }
+    }
+
+    // User classes appended after a component's own ones in class="..."
+    void render_classes(Sink& out) const {
+        const std::string& classes = attrs_.get(Attr::Classes);
+        if (!classes.empty()) out << " " << classes;
+    }
+
+    void render_children(const std::vector<ComponentPtr>& children, Sink& out) const {
+        const ParallelRender* parallel = parallel_render();
+        if (parallel && worth_splitting(children, *parallel)) {
+            render_children_parallel(children, out, *parallel);
+            return;
+        }
         for (const auto& child : children) {
-            html << child->render();
+            render_child(*child, out);
+        }
+    }
+
+private:
+    template<typename T> friend SharedComponent freeze(T&& component);
+
+    void seal() {
+        if (is_frozen()) return;
+        enable_cache(true);
+        RenderCache& cache = *cache_.get();
+        CacheFillScope scope(nullptr);
+        StringSink buffer(cache.bytes);
+        render_to(buffer);
+        cache.valid = true;
+        cache.frozen = true;
+    }
+
+    CacheLinks& links() const {
+        RenderCache* own = cache_.get();
+        return own ? own->up : up_;
+    }
+
+    void link(const std::shared_ptr<RenderCache>& cache) const {
+        if (is_frozen()) return;
+        std::lock_guard<std::mutex> lock(cache_link_mutex());
+        std::vector<std::weak_ptr<RenderCache>>& caches = links().caches;
+        for (const std::weak_ptr<RenderCache>& known : caches) {
+            if (!known.owner_before(cache) && !cache.owner_before(known)) return;
+        }
+        // Drop caches whose owners are gone before adding this one
+        caches.erase(std::remove_if(caches.begin(), caches.end(),
+                                    [](const std::weak_ptr<RenderCache>& c) { return c.expired(); }),
+                     caches.end());
+        caches.push_back(cache);
+    }
+
+    // Marks every cache reachable upwards from links stale, stopping at
+    // caches that already are (their own caches were marked with them)
+    static void invalidate(const CacheLinks& links) {
+        std::lock_guard<std::mutex> lock(cache_link_mutex());
+        std::vector<std::shared_ptr<RenderCache>> pending;
+        auto push = [&pending](const CacheLinks& from) {
+            for (const std::weak_ptr<RenderCache>& weak : from.caches) {
+                if (std::shared_ptr<RenderCache> cache = weak.lock()) pending.push_back(std::move(cache));
+            }
+        };
+        push(links);
+        while (!pending.empty()) {
+            std::shared_ptr<RenderCache> cache = std::move(pending.back());
+            pending.pop_back();
+            if (!cache->dirty.exchange(true, std::memory_order_acq_rel)) push(cache->up);
+        }
+    }
+
+    static bool worth_splitting(const std::vector<ComponentPtr>& children, const ParallelRender& parallel) {
+        if (children.size() < 2) return false;
+        if (children.size() >= parallel.min_children) return true;
+        return std::any_of(children.begin(), children.end(),
+                           [](const ComponentPtr& child) { return child->expensive_to_render(); });
+    }
+
+    // Each child renders into its own buffer on the pool; the buffers are
+    // then written out in order, so the bytes match a serial render
+    static void render_children_parallel(const std::vector<ComponentPtr>& children, Sink& out,
+                                         const ParallelRender& parallel) {
+        std::vector<std::string> parts(children.size());
+        const std::shared_ptr<RenderCache>* fill = filling_cache();
+        TaskGroup group(*parallel.pool);
+        for (size_t i = 0; i < children.size(); ++i) {
+            group.run([&children, &parts, &parallel, fill, i] {
+                ParallelRenderScope scope(&parallel);
+                CacheFillScope filling(fill);
+                StringSink buffer(parts[i]);
+                render_child(*children[i], buffer);
+            });
+        }
+        group.wait();
+        for (const auto& part : parts) {
+            out << std::string_view(part);
         }
-        return html.str();
     }
 };
 
+// Turns a finished subtree into an immutable node that any number of pages
+// can add at no cost: the tree is moved (or copied) in once, rendered once,
+// and from then on every page splices in the same bytes. Nothing inside it,
+// including nodes you still hold a std::shared_ptr handle to, may change.
+//
+//     SharedComponent chrome = freeze(std::move(navbar));
+//     page_a.add(chrome);
+//     page_b.add(chrome);
+template<typename T>
+SharedComponent freeze(T&& component) {
+    ComponentPtr node = make_component(std::forward<T>(component));
+    node->seal();
+    return node;
+}
+
 // ============================================================================
 // Text Components
 // ============================================================================
 
+// Paragraph or heading. A heading ignores the tone.
+enum class TextLevel : unsigned char { Body, H1, H2, H3 };
+
+// Ordered by precedence: when several tones are set the highest one wins
+enum class TextTone : unsigned char { Normal, Accent, Muted, Secondary };
+
 class Text : public Component {
 public:
     std::string content_;
-    int heading_level_ = 0;
-    bool secondary_ = false;
-    bool muted_ = false;
-    bool accent_ = false;
+    TextLevel level_ = TextLevel::Body;
+    TextTone tone_ = TextTone::Normal;
 
     Text() = default;
     explicit Text(const std::string& content) : content_(content) {}
 
-    Text& content(const std::string& c) { content_ = c; return *this; }
-    Text& h1() { heading_level_ = 1; return *this; }
-    Text& h2() { heading_level_ = 2; return *this; }
-    Text& h3() { heading_level_ = 3; return *this; }
-    Text& secondary() { secondary_ = true; return *this; }
-    Text& muted() { muted_ = true; return *this; }
-    Text& accent() { accent_ = true; return *this; }
-    Text& id(const std::string& i) { id_ = i; return *this; }
-    Text& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string tag = "p";
-        std::string cls = "ew-text";
-
-        if (heading_level_ == 1) { tag = "h1"; cls = "ew-heading-1"; }
-        else if (heading_level_ == 2) { tag = "h2"; cls = "ew-heading-2"; }
-        else if (heading_level_ == 3) { tag = "h3"; cls = "ew-heading-3"; }
-        else if (secondary_) { cls += " ew-text-secondary"; }
-        else if (muted_) { cls += " ew-text-muted"; }
-        else if (accent_) { cls += " ew-text-accent"; }
-
-        if (!classes_.empty()) cls += " " + classes_;
-
-        html << "<" << tag << " class=\"" << cls << "\"" << render_attributes() << ">";
-        html << content_;
-        html << "</" << tag << ">";
-        return html.str();
+    Text& content(const std::string& c) { content_ = c; touch(); return *this; }
+    Text& h1() { level_ = TextLevel::H1; touch(); return *this; }
+    Text& h2() { level_ = TextLevel::H2; touch(); return *this; }
+    Text& h3() { level_ = TextLevel::H3; touch(); return *this; }
+    Text& secondary() { return tone(TextTone::Secondary); }
+    Text& muted() { return tone(TextTone::Muted); }
+    Text& accent() { return tone(TextTone::Accent); }
+    Text& tone(TextTone t) { tone_ = std::max(tone_, t); touch(); return *this; }
+    Text& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Text& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        switch (level_) {
+            case TextLevel::H1: out << "<h1 class=\"ew-heading-1"; break;
+            case TextLevel::H2: out << "<h2 class=\"ew-heading-2"; break;
+            case TextLevel::H3: out << "<h3 class=\"ew-heading-3"; break;
+            case TextLevel::Body:
+                switch (tone_) {
+                    case TextTone::Normal: out << "<p class=\"ew-text"; break;
+                    case TextTone::Accent: out << "<p class=\"ew-text ew-text-accent"; break;
+                    case TextTone::Muted: out << "<p class=\"ew-text ew-text-muted"; break;
+                    case TextTone::Secondary: out << "<p class=\"ew-text ew-text-secondary"; break;
+                }
+                break;
+        }
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">" << content_;
+        switch (level_) {
+            case TextLevel::H1: out << "</h1>"; break;
+            case TextLevel::H2: out << "</h2>"; break;
+            case TextLevel::H3: out << "</h3>"; break;
+            case TextLevel::Body: out << "</p>"; break;
+        }
     }
 };
 
@@ -115,27 +538,50 @@ public:
 
 class Divider : public Component {
 public:
-    std::string render() const override {
-        return "<hr class=\"ew-divider\">";
+    void render_to(Sink& out) const override {
+        out << "<hr class=\"ew-divider\">";
     }
 };
 
+// Step on the spacing scale, used by Spacer and by Row/Column gaps
+enum class Spacing : unsigned char { Sm, Md, Lg, Xl };
+
+// "sm", "md", "lg" or "xl"; anything else is the default, Md
+inline Spacing parse_spacing(const std::string& s) {
+    if (s == "sm") return Spacing::Sm;
+    if (s == "lg") return Spacing::Lg;
+    if (s == "xl") return Spacing::Xl;
+    return Spacing::Md;
+}
+
+// Gap class for Row/Column; Md is the stylesheet default and has none
+inline void render_gap(Sink& out, Spacing gap) {
+    switch (gap) {
+        case Spacing::Sm: out << " ew-gap-sm"; break;
+        case Spacing::Md: break;
+        case Spacing::Lg: out << " ew-gap-lg"; break;
+        case Spacing::Xl: out << " ew-gap-xl"; break;
+    }
+}
+
 class Spacer : public Component {
 public:
-    std::string size_ = "md";
+    Spacing size_ = Spacing::Md;
 
     Spacer() = default;
 
-    Spacer& sm() { size_ = "sm"; return *this; }
-    Spacer& lg() { size_ = "lg"; return *this; }
-    Spacer& xl() { size_ = "xl"; return *this; }
-
-    std::string render() const override {
-        std::string cls = "ew-spacer";
-        if (size_ == "sm") cls += "-sm";
-        else if (size_ == "lg") cls += "-lg";
-        else if (size_ == "xl") cls += "-xl";
-        return "<div class=\"" + cls + "\"></div>";
+    Spacer& sm() { return size(Spacing::Sm); }
+    Spacer& lg() { return size(Spacing::Lg); }
+    Spacer& xl() { return size(Spacing::Xl); }
+    Spacer& size(Spacing s) { size_ = s; touch(); return *this; }
+
+    void render_to(Sink& out) const override {
+        switch (size_) {
+            case Spacing::Sm: out << "<div class=\"ew-spacer-sm\"></div>"; break;
+            case Spacing::Md: out << "<div class=\"ew-spacer\"></div>"; break;
+            case Spacing::Lg: out << "<div class=\"ew-spacer-lg\"></div>"; break;
+            case Spacing::Xl: out << "<div class=\"ew-spacer-xl\"></div>"; break;
+        }
     }
 };
 
@@ -147,70 +593,78 @@ public:
     Image() = default;
     explicit Image(const std::string& src) : src_(src) {}
 
-    Image& src(const std::string& s) { src_ = s; return *this; }
-    Image& alt(const std::string& a) { alt_ = a; return *this; }
-    Image& id(const std::string& i) { id_ = i; return *this; }
-    Image& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-image";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<img src=\"" << src_ << "\" alt=\"" << alt_ << "\" class=\"" << cls << "\"" << render_attributes() << ">";
-        return html.str();
+    Image& src(const std::string& s) { src_ = s; touch(); return *this; }
+    Image& alt(const std::string& a) { alt_ = a; touch(); return *this; }
+    Image& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Image& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<img src=\"" << src_ << "\" alt=\"" << alt_ << "\" class=\"ew-image";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
     }
 };
 
+enum class BadgeVariant : unsigned char { Default, Success, Warning, Error };
+
 // Badge component
 class Badge : public Component {
 public:
     std::string text_;
-    std::string variant_ = "default"; // default, success, warning, error
+    BadgeVariant variant_ = BadgeVariant::Default;
 
     Badge() = default;
     explicit Badge(const std::string& text) : text_(text) {}
 
-    Badge& text(const std::string& t) { text_ = t; return *this; }
-    Badge& success() { variant_ = "success"; return *this; }
-    Badge& warning() { variant_ = "warning"; return *this; }
-    Badge& error() { variant_ = "error"; return *this; }
-
-    std::string render() const override {
-        std::string cls = "ew-badge";
-        if (variant_ == "success") cls += " ew-badge-success";
-        else if (variant_ == "warning") cls += " ew-badge-warning";
-        else if (variant_ == "error") cls += " ew-badge-error";
-        return "<span class=\"" + cls + "\">" + text_ + "</span>";
+    Badge& text(const std::string& t) { text_ = t; touch(); return *this; }
+    Badge& success() { return variant(BadgeVariant::Success); }
+    Badge& warning() { return variant(BadgeVariant::Warning); }
+    Badge& error() { return variant(BadgeVariant::Error); }
+    Badge& variant(BadgeVariant v) { variant_ = v; touch(); return *this; }
+
+    void render_to(Sink& out) const override {
+        switch (variant_) {
+            case BadgeVariant::Default: out << "<span class=\"ew-badge\">"; break;
+            case BadgeVariant::Success: out << "<span class=\"ew-badge ew-badge-success\">"; break;
+            case BadgeVariant::Warning: out << "<span class=\"ew-badge ew-badge-warning\">"; break;
+            case BadgeVariant::Error: out << "<span class=\"ew-badge ew-badge-error\">"; break;
+        }
+        out << text_ << "</span>";
     }
 };
 
+enum class Trend : unsigned char { Up, Down };
+
 // Stat component for dashboard metrics
 class Stat : public Component {
 public:
     std::string label_;
     std::string value_;
     std::string change_;
-    bool change_up_ = true;
+    Trend trend_ = Trend::Up;
 
     Stat() = default;
 
-    Stat& label(const std::string& l) { label_ = l; return *this; }
-    Stat& value(const std::string& v) { value_ = v; return *this; }
-    Stat& change(const std::string& c, bool up = true) { change_ = c; change_up_ = up; return *this; }
-    Stat& id(const std::string& i) { id_ = i; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<div class=\"ew-stat\"" << render_attributes() << ">";
-        html << "<span class=\"ew-stat-label\">" << label_ << "</span>";
-        html << "<span class=\"ew-stat-value\">" << value_ << "</span>";
+    Stat& label(const std::string& l) { label_ = l; touch(); return *this; }
+    Stat& value(const std::string& v) { value_ = v; touch(); return *this; }
+    Stat& change(const std::string& c, bool up = true) { return change(c, up ? Trend::Up : Trend::Down); }
+    Stat& change(const std::string& c, Trend t) { change_ = c; trend_ = t; touch(); return *this; }
+    Stat& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-stat\"";
+        render_attributes(out);
+        out << ">";
+        out << "<span class=\"ew-stat-label\">" << label_ << "</span>";
+        out << "<span class=\"ew-stat-value\">" << value_ << "</span>";
         if (!change_.empty()) {
-            html << "<span class=\"ew-stat-change " << (change_up_ ? "ew-stat-change-up" : "ew-stat-change-down") << "\">";
-            html << (change_up_ ? "+" : "") << change_;
-            html << "</span>";
+            if (trend_ == Trend::Up) out << "<span class=\"ew-stat-change ew-stat-change-up\">+";
+            else out << "<span class=\"ew-stat-change ew-stat-change-down\">";
+            out << change_ << "</span>";
         }
-        html << "</div>";
-        return html.str();
+        out << "</div>";
     }
 };
 
@@ -218,36 +672,42 @@ public:
 // Interactive Components
 // ============================================================================
 
+enum class ButtonVariant : unsigned char { Primary, Secondary, Outline, Ghost };
+
 class Button : public Component {
 public:
     std::string label_;
-    std::string variant_ = "primary"; // primary, secondary, outline, ghost
+    ButtonVariant variant_ = ButtonVariant::Primary;
 
     Button() = default;
     explicit Button(const std::string& label) : label_(label) {}
 
-    Button& label(const std::string& l) { label_ = l; return *this; }
-    Button& secondary() { variant_ = "secondary"; return *this; }
-    Button& outline() { variant_ = "outline"; return *this; }
-    Button& ghost() { variant_ = "ghost"; return *this; }
-    Button& id(const std::string& i) { id_ = i; return *this; }
-    Button& classes(const std::string& c) { classes_ = c; return *this; }
-
-    Button& action(const std::string& url) { hx_post_ = url; return *this; }
-    Button& get(const std::string& url) { hx_get_ = url; return *this; }
-    Button& post(const std::string& url) { hx_post_ = url; return *this; }
-    Button& target(const std::string& t) { hx_target_ = t; return *this; }
-    Button& swap(const std::string& s) { hx_swap_ = s; return *this; }
-    Button& trigger(const std::string& t) { hx_trigger_ = t; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-button ew-button-" + variant_;
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<button class=\"" << cls << "\"" << render_attributes() << ">";
-        html << label_;
-        html << "</button>";
-        return html.str();
+    Button& label(const std::string& l) { label_ = l; touch(); return *this; }
+    Button& secondary() { return variant(ButtonVariant::Secondary); }
+    Button& outline() { return variant(ButtonVariant::Outline); }
+    Button& ghost() { return variant(ButtonVariant::Ghost); }
+    Button& variant(ButtonVariant v) { variant_ = v; touch(); return *this; }
+    Button& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Button& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    Button& action(const std::string& url) { set_attr(Attr::HxPost, url); return *this; }
+    Button& get(const std::string& url) { set_attr(Attr::HxGet, url); return *this; }
+    Button& post(const std::string& url) { set_attr(Attr::HxPost, url); return *this; }
+    Button& target(const std::string& t) { set_attr(Attr::HxTarget, t); return *this; }
+    Button& swap(const std::string& s) { set_attr(Attr::HxSwap, s); return *this; }
+    Button& trigger(const std::string& t) { set_attr(Attr::HxTrigger, t); return *this; }
+
+    void render_to(Sink& out) const override {
+        switch (variant_) {
+            case ButtonVariant::Primary: out << "<button class=\"ew-button ew-button-primary"; break;
+            case ButtonVariant::Secondary: out << "<button class=\"ew-button ew-button-secondary"; break;
+            case ButtonVariant::Outline: out << "<button class=\"ew-button ew-button-outline"; break;
+            case ButtonVariant::Ghost: out << "<button class=\"ew-button ew-button-ghost"; break;
+        }
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">" << label_ << "</button>";
     }
 };
 
@@ -259,19 +719,17 @@ public:
     Link() = default;
     Link(const std::string& label, const std::string& href) : label_(label), href_(href) {}
 
-    Link& label(const std::string& l) { label_ = l; return *this; }
-    Link& href(const std::string& h) { href_ = h; return *this; }
-    Link& id(const std::string& i) { id_ = i; return *this; }
-    Link& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-link";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<a href=\"" << href_ << "\" class=\"" << cls << "\"" << render_attributes() << ">";
-        html << label_;
-        html << "</a>";
-        return html.str();
+    Link& label(const std::string& l) { label_ = l; touch(); return *this; }
+    Link& href(const std::string& h) { href_ = h; touch(); return *this; }
+    Link& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Link& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<a href=\"" << href_ << "\" class=\"ew-link";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">" << label_ << "</a>";
     }
 };
 
@@ -290,37 +748,34 @@ public:
     Input() = default;
     explicit Input(const std::string& name) : name_(name) {}
 
-    Input& name(const std::string& n) { name_ = n; return *this; }
-    Input& type(const std::string& t) { type_ = t; return *this; }
-    Input& placeholder(const std::string& p) { placeholder_ = p; return *this; }
-    Input& value(const std::string& v) { value_ = v; return *this; }
-    Input& label(const std::string& l) { label_text_ = l; return *this; }
-    Input& id(const std::string& i) { id_ = i; return *this; }
-    Input& classes(const std::string& c) { classes_ = c; return *this; }
+    Input& name(const std::string& n) { name_ = n; touch(); return *this; }
+    Input& type(const std::string& t) { type_ = t; touch(); return *this; }
+    Input& placeholder(const std::string& p) { placeholder_ = p; touch(); return *this; }
+    Input& value(const std::string& v) { value_ = v; touch(); return *this; }
+    Input& label(const std::string& l) { label_text_ = l; touch(); return *this; }
+    Input& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Input& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string input_id = id_.empty() ? name_ : id_;
+    void render_to(Sink& out) const override {
+        const std::string& input_id = attr(Attr::Id).empty() ? name_ : attr(Attr::Id);
 
         if (!label_text_.empty()) {
-            html << "<div class=\"ew-form-group\">";
-            html << "<label class=\"ew-label\" for=\"" << input_id << "\">" << label_text_ << "</label>";
+            out << "<div class=\"ew-form-group\">";
+            out << "<label class=\"ew-label\" for=\"" << input_id << "\">" << label_text_ << "</label>";
         }
 
-        std::string cls = "ew-input";
-        if (!classes_.empty()) cls += " " + classes_;
-
-        html << "<input type=\"" << type_ << "\" name=\"" << name_ << "\"";
-        html << " id=\"" << input_id << "\" class=\"" << cls << "\"";
-        if (!placeholder_.empty()) html << " placeholder=\"" << placeholder_ << "\"";
-        if (!value_.empty()) html << " value=\"" << value_ << "\"";
-        html << render_attributes() << ">";
+        out << "<input type=\"" << type_ << "\" name=\"" << name_ << "\"";
+        out << " id=\"" << input_id << "\" class=\"ew-input";
+        render_classes(out);
+        out << "\"";
+        if (!placeholder_.empty()) out << " placeholder=\"" << placeholder_ << "\"";
+        if (!value_.empty()) out << " value=\"" << value_ << "\"";
+        render_attributes(out);
+        out << ">";
 
         if (!label_text_.empty()) {
-            html << "</div>";
+            out << "</div>";
         }
-
-        return html.str();
     }
 };
 
@@ -337,34 +792,42 @@ public:
     template<typename T>
     Box& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Box& id(const std::string& i) { id_ = i; return *this; }
-    Box& classes(const std::string& c) { classes_ = c; return *this; }
+    Box& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Box& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
 
     // HTMX attributes
-    Box& get(const std::string& url) { hx_get_ = url; return *this; }
-    Box& post(const std::string& url) { hx_post_ = url; return *this; }
-    Box& target(const std::string& t) { hx_target_ = t; return *this; }
-    Box& swap(const std::string& s) { hx_swap_ = s; return *this; }
-    Box& trigger(const std::string& t) { hx_trigger_ = t; return *this; }
-    Box& ext(const std::string& e) { hx_ext_ = e; return *this; }
-    Box& vals(const std::string& v) { hx_vals_ = v; return *this; }
+    Box& get(const std::string& url) { set_attr(Attr::HxGet, url); return *this; }
+    Box& post(const std::string& url) { set_attr(Attr::HxPost, url); return *this; }
+    Box& target(const std::string& t) { set_attr(Attr::HxTarget, t); return *this; }
+    Box& swap(const std::string& s) { set_attr(Attr::HxSwap, s); return *this; }
+    Box& trigger(const std::string& t) { set_attr(Attr::HxTrigger, t); return *this; }
+    Box& ext(const std::string& e) { set_attr(Attr::HxExt, e); return *this; }
+    Box& vals(const std::string& v) { set_attr(Attr::HxVals, v); return *this; }
 
     // SSE attributes
-    Box& sse_connect(const std::string& url) { hx_ext_ = "sse"; sse_connect_ = url; return *this; }
-    Box& sse_swap(const std::string& event) { sse_swap_ = event; return *this; }
-    Box& sse_close(const std::string& event) { sse_close_ = event; return *this; }
+    Box& sse_connect(const std::string& url) { set_attr(Attr::HxExt, "sse"); set_attr(Attr::SseConnect, url); return *this; }
+    Box& sse_swap(const std::string& event) { set_attr(Attr::SseSwap, event); return *this; }
+    Box& sse_close(const std::string& event) { set_attr(Attr::SseClose, event); return *this; }
+
+    // Cache the rendered subtree until something inside it changes
+    Box& cached(bool on = true) { enable_cache(on); return *this; }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-box";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</div>";
-        return html.str();
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-box";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</div>";
     }
 };
 
@@ -381,34 +844,41 @@ public:
     template<typename T>
     Card& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Card& title(const std::string& t) { title_ = t; return *this; }
-    Card& compact() { compact_ = true; return *this; }
-    Card& accent() { accent_ = true; return *this; }
-    Card& border(const std::string& color) { border_color_ = color; return *this; }
-    Card& mobile_full() { classes_ += " ew-card-mobile-full"; return *this; }
-    Card& id(const std::string& i) { id_ = i; return *this; }
-    Card& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-card";
-        if (compact_) cls += " ew-card-compact";
-        if (accent_) cls += " ew-card-accent";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"";
+    Card& title(const std::string& t) { title_ = t; touch(); return *this; }
+    Card& compact() { compact_ = true; touch(); return *this; }
+    Card& accent() { accent_ = true; touch(); return *this; }
+    Card& border(const std::string& color) { border_color_ = color; touch(); return *this; }
+    Card& mobile_full() { append_attr(Attr::Classes, " ew-card-mobile-full"); return *this; }
+    Card& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Card& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    // Cache the rendered subtree until something inside it changes
+    Card& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-card";
+        if (compact_) out << " ew-card-compact";
+        if (accent_) out << " ew-card-accent";
+        render_classes(out);
+        out << "\"";
         if (!border_color_.empty()) {
-            html << " style=\"border-color: " << border_color_ << ";\"";
+            out << " style=\"border-color: " << border_color_ << ";\"";
         }
-        html << render_attributes() << ">";
+        render_attributes(out);
+        out << ">";
         if (!title_.empty()) {
-            html << "<div class=\"ew-card-title\">" << title_ << "</div>";
+            out << "<div class=\"ew-card-title\">" << title_ << "</div>";
         }
-        html << render_children(children_);
-        html << "</div>";
-        return html.str();
+        render_children(children_, out);
+        out << "</div>";
     }
 };
 
@@ -416,66 +886,80 @@ class Row : public Component {
 public:
     std::vector<ComponentPtr> children_;
     bool wrap_ = false;
-    std::string gap_;
+    Spacing gap_ = Spacing::Md;
 
     Row() = default;
 
     template<typename T>
     Row& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Row& wrap() { wrap_ = true; return *this; }
-    Row& gap(const std::string& g) { gap_ = g; return *this; }
-    Row& stack_mobile() { classes_ += " ew-row-mobile-stack"; return *this; }
-    Row& center_mobile() { classes_ += " ew-center-mobile"; return *this; }
-    Row& id(const std::string& i) { id_ = i; return *this; }
-    Row& classes(const std::string& c) { classes_ = c; return *this; }
+    Row& wrap() { wrap_ = true; touch(); return *this; }
+    Row& gap(const std::string& g) { return gap(parse_spacing(g)); }
+    Row& gap(Spacing g) { gap_ = g; touch(); return *this; }
+    Row& stack_mobile() { append_attr(Attr::Classes, " ew-row-mobile-stack"); return *this; }
+    Row& center_mobile() { append_attr(Attr::Classes, " ew-center-mobile"); return *this; }
+    Row& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Row& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-row";
-        if (wrap_) cls += " ew-row-wrap";
-        if (gap_ == "sm") cls += " ew-gap-sm";
-        else if (gap_ == "lg") cls += " ew-gap-lg";
-        else if (gap_ == "xl") cls += " ew-gap-xl";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</div>";
-        return html.str();
+    // Cache the rendered subtree until something inside it changes
+    Row& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-row";
+        if (wrap_) out << " ew-row-wrap";
+        render_gap(out, gap_);
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</div>";
     }
 };
 
 class Column : public Component {
 public:
     std::vector<ComponentPtr> children_;
-    std::string gap_;
+    Spacing gap_ = Spacing::Md;
 
     Column() = default;
 
     template<typename T>
     Column& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Column& gap(const std::string& g) { gap_ = g; return *this; }
-    Column& id(const std::string& i) { id_ = i; return *this; }
-    Column& classes(const std::string& c) { classes_ = c; return *this; }
+    Column& gap(const std::string& g) { return gap(parse_spacing(g)); }
+    Column& gap(Spacing g) { gap_ = g; touch(); return *this; }
+    Column& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Column& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    // Cache the rendered subtree until something inside it changes
+    Column& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-column";
-        if (gap_ == "sm") cls += " ew-gap-sm";
-        else if (gap_ == "lg") cls += " ew-gap-lg";
-        else if (gap_ == "xl") cls += " ew-gap-xl";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</div>";
-        return html.str();
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-column";
+        render_gap(out, gap_);
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</div>";
     }
 };
 
@@ -490,27 +974,35 @@ public:
     template<typename T>
     Grid& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Grid& columns(int c) { columns_ = c; return *this; }
-    Grid& responsive(bool r = true) { responsive_ = r; return *this; }
-    Grid& id(const std::string& i) { id_ = i; return *this; }
-    Grid& classes(const std::string& c) { classes_ = c; return *this; }
+    Grid& columns(int c) { columns_ = c; touch(); return *this; }
+    Grid& responsive(bool r = true) { responsive_ = r; touch(); return *this; }
+    Grid& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Grid& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = responsive_ ? "ew-grid-responsive" : "ew-grid";
+    // Cache the rendered subtree until something inside it changes
+    Grid& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"" << (responsive_ ? "ew-grid-responsive" : "ew-grid");
         if (!responsive_) {
-            if (columns_ == 2) cls += " ew-grid-2";
-            else if (columns_ == 3) cls += " ew-grid-3";
-            else if (columns_ == 4) cls += " ew-grid-4";
+            if (columns_ == 2) out << " ew-grid-2";
+            else if (columns_ == 3) out << " ew-grid-3";
+            else if (columns_ == 4) out << " ew-grid-4";
         }
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</div>";
-        return html.str();
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</div>";
     }
 };
 
@@ -525,27 +1017,31 @@ public:
     template<typename T>
     Form& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Form& action(const std::string& a) { action_ = a; return *this; }
-    Form& method(const std::string& m) { method_ = m; return *this; }
-    Form& id(const std::string& i) { id_ = i; return *this; }
-    Form& classes(const std::string& c) { classes_ = c; return *this; }
-    Form& post(const std::string& url) { hx_post_ = url; return *this; }
-    Form& get(const std::string& url) { hx_get_ = url; return *this; }
-    Form& target(const std::string& t) { hx_target_ = t; return *this; }
-    Form& swap(const std::string& s) { hx_swap_ = s; return *this; }
+    Form& action(const std::string& a) { action_ = a; touch(); return *this; }
+    Form& method(const std::string& m) { method_ = m; touch(); return *this; }
+    Form& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Form& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+    Form& post(const std::string& url) { set_attr(Attr::HxPost, url); return *this; }
+    Form& get(const std::string& url) { set_attr(Attr::HxGet, url); return *this; }
+    Form& target(const std::string& t) { set_attr(Attr::HxTarget, t); return *this; }
+    Form& swap(const std::string& s) { set_attr(Attr::HxSwap, s); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
 
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<form";
-        if (!action_.empty()) html << " action=\"" << action_ << "\"";
-        html << " method=\"" << method_ << "\"";
-        html << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</form>";
-        return html.str();
+    void render_to(Sink& out) const override {
+        out << "<form";
+        if (!action_.empty()) out << " action=\"" << action_ << "\"";
+        out << " method=\"" << method_ << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</form>";
     }
 };
 
@@ -563,14 +1059,14 @@ public:
     NavItem() = default;
     explicit NavItem(const std::string& label) : label_(label) {}
 
-    NavItem& label(const std::string& l) { label_ = l; return *this; }
-    NavItem& href(const std::string& h) { href_ = h; return *this; }
-    NavItem& active() { active_ = true; return *this; }
+    NavItem& label(const std::string& l) { label_ = l; touch(); return *this; }
+    NavItem& href(const std::string& h) { href_ = h; touch(); return *this; }
+    NavItem& active() { active_ = true; touch(); return *this; }
 
-    std::string render() const override {
-        std::string cls = "ew-navbar-item";
-        if (active_) cls += " ew-navbar-item-active";
-        return "<a href=\"" + href_ + "\" class=\"" + cls + "\">" + label_ + "</a>";
+    void render_to(Sink& out) const override {
+        out << "<a href=\"" << href_ << "\" class=\"ew-navbar-item";
+        if (active_) out << " ew-navbar-item-active";
+        out << "\">" << label_ << "</a>";
     }
 };
 
@@ -583,34 +1079,39 @@ public:
 
     Navbar() = default;
 
-    Navbar& brand(const std::string& b) { brand_ = b; return *this; }
+    Navbar& brand(const std::string& b) { brand_ = b; touch(); return *this; }
 
     template<typename T>
     Navbar& add(T&& item) {
         nav_items_.push_back(make_component(std::forward<T>(item)));
+        touch();
         return *this;
     }
 
     template<typename T>
     Navbar& addAction(T&& action) {
         actions_.push_back(make_component(std::forward<T>(action)));
+        touch();
         return *this;
     }
 
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<nav class=\"ew-navbar\">";
-        html << "<a href=\"#\" class=\"ew-navbar-brand\">" << brand_ << "</a>";
-        html << "<div class=\"ew-navbar-nav\">";
-        html << render_children(nav_items_);
-        html << "</div>";
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(nav_items_, fn);
+        visit(actions_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<nav class=\"ew-navbar\">";
+        out << "<a href=\"#\" class=\"ew-navbar-brand\">" << brand_ << "</a>";
+        out << "<div class=\"ew-navbar-nav\">";
+        render_children(nav_items_, out);
+        out << "</div>";
         if (!actions_.empty()) {
-            html << "<div class=\"ew-navbar-actions\">";
-            html << render_children(actions_);
-            html << "</div>";
+            out << "<div class=\"ew-navbar-actions\">";
+            render_children(actions_, out);
+            out << "</div>";
         }
-        html << "</nav>";
-        return html.str();
+        out << "</nav>";
     }
 };
 
@@ -624,14 +1125,14 @@ public:
     SidebarItem() = default;
     explicit SidebarItem(const std::string& label) : label_(label) {}
 
-    SidebarItem& label(const std::string& l) { label_ = l; return *this; }
-    SidebarItem& href(const std::string& h) { href_ = h; return *this; }
-    SidebarItem& active() { active_ = true; return *this; }
+    SidebarItem& label(const std::string& l) { label_ = l; touch(); return *this; }
+    SidebarItem& href(const std::string& h) { href_ = h; touch(); return *this; }
+    SidebarItem& active() { active_ = true; touch(); return *this; }
 
-    std::string render() const override {
-        std::string cls = "ew-sidebar-item";
-        if (active_) cls += " ew-sidebar-item-active";
-        return "<a href=\"" + href_ + "\" class=\"" + cls + "\">" + label_ + "</a>";
+    void render_to(Sink& out) const override {
+        out << "<a href=\"" << href_ << "\" class=\"ew-sidebar-item";
+        if (active_) out << " ew-sidebar-item-active";
+        out << "\">" << label_ << "</a>";
     }
 };
 
@@ -644,25 +1145,28 @@ public:
     SidebarSection() = default;
     explicit SidebarSection(const std::string& title) : title_(title) {}
 
-    SidebarSection& title(const std::string& t) { title_ = t; return *this; }
+    SidebarSection& title(const std::string& t) { title_ = t; touch(); return *this; }
 
     template<typename T>
     SidebarSection& add(T&& item) {
         items_.push_back(make_component(std::forward<T>(item)));
+        touch();
         return *this;
     }
 
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<div class=\"ew-sidebar-section\">";
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(items_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-sidebar-section\">";
         if (!title_.empty()) {
-            html << "<div class=\"ew-sidebar-title\">" << title_ << "</div>";
+            out << "<div class=\"ew-sidebar-title\">" << title_ << "</div>";
         }
-        html << "<nav class=\"ew-sidebar-nav\">";
-        html << render_children(items_);
-        html << "</nav>";
-        html << "</div>";
-        return html.str();
+        out << "<nav class=\"ew-sidebar-nav\">";
+        render_children(items_, out);
+        out << "</nav>";
+        out << "</div>";
     }
 };
 
@@ -676,15 +1180,18 @@ public:
     template<typename T>
     Sidebar& add(T&& section) {
         sections_.push_back(make_component(std::forward<T>(section)));
+        touch();
         return *this;
     }
 
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<aside class=\"ew-sidebar\">";
-        html << render_children(sections_);
-        html << "</aside>";
-        return html.str();
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(sections_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<aside class=\"ew-sidebar\">";
+        render_children(sections_, out);
+        out << "</aside>";
     }
 };
 
@@ -698,20 +1205,28 @@ public:
     template<typename T>
     Main& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    Main& id(const std::string& i) { id_ = i; return *this; }
-    Main& classes(const std::string& c) { classes_ = c; return *this; }
+    Main& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    Main& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    // Cache the rendered subtree until something inside it changes
+    Main& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-main";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<main class=\"" << cls << "\"" << render_attributes() << ">";
-        html << render_children(children_);
-        html << "</main>";
-        return html.str();
+    void render_to(Sink& out) const override {
+        out << "<main class=\"ew-main";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        render_children(children_, out);
+        out << "</main>";
     }
 };
 
@@ -727,33 +1242,43 @@ public:
     template<typename T>
     App& navbar(T&& nav) {
         navbar_ = make_component(std::forward<T>(nav));
+        touch();
         return *this;
     }
 
     template<typename T>
     App& sidebar(T&& side) {
         sidebar_ = make_component(std::forward<T>(side));
+        touch();
         return *this;
     }
 
     template<typename T>
     App& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    std::string render() const override {
-        std::ostringstream html;
-        html << "<div class=\"ew-app\">";
-        if (navbar_) html << navbar_->render();
-        html << "<div class=\"ew-app-body\">";
-        if (sidebar_) html << sidebar_->render();
-        html << "<main class=\"ew-main\">";
-        html << render_children(children_);
-        html << "</main>";
-        html << "</div>";
-        html << "</div>";
-        return html.str();
+    // Cache the rendered subtree until something inside it changes
+    App& cached(bool on = true) { enable_cache(on); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        if (navbar_) fn(*navbar_);
+        if (sidebar_) fn(*sidebar_);
+        visit(children_, fn);
+    }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-app\">";
+        if (navbar_) render_child(*navbar_, out);
+        out << "<div class=\"ew-app-body\">";
+        if (sidebar_) render_child(*sidebar_, out);
+        out << "<main class=\"ew-main\">";
+        render_children(children_, out);
+        out << "</main>";
+        out << "</div>";
+        out << "</div>";
     }
 };
 
@@ -761,15 +1286,15 @@ public:
 // Page Component (Root)
 // ============================================================================
 
-// Theme mode enum (forward declare, defined in styles.hpp)
-enum class ThemeMode;
+struct PageHead;
+class BuildManifest;
 
 class Page : public Component {
 public:
     std::vector<ComponentPtr> children_;
     std::string title_;
     bool include_htmx_ = true;
-    int theme_mode_ = 0; // 0=Dark, 1=Light, 2=Cream
+    ThemeHandle theme_;
 
     Page() = default;
     explicit Page(const std::string& title) : title_(title) {}
@@ -777,21 +1302,247 @@ public:
     template<typename T>
     Page& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
+        return *this;
+    }
+
+    Page& title(const std::string& t) { title_ = t; touch(); return *this; }
+    Page& no_htmx() { include_htmx_ = false; touch(); return *this; }
+    // htmx and its SSE extension are included only when something in the
+    // tree uses them (see Component::scripts_needed()). with_htmx() and
+    // with_sse() include them regardless, for markup swapped in later.
+    Page& with_htmx() { detect_scripts_ = false; include_htmx_ = true; touch(); return *this; }
+    Page& auto_scripts(bool on = true) { detect_scripts_ = on; touch(); return *this; }
+    Page& dark_mode() { return theme(ThemeRegistry::global().builtin(ThemeMode::Dark)); }
+    Page& light_mode() { return theme(ThemeRegistry::global().builtin(ThemeMode::Light)); }
+    Page& cream_mode() { return theme(ThemeRegistry::global().builtin(ThemeMode::Cream)); }
+    // Any theme from ThemeRegistry; its stylesheet is generated once and
+    // shared by every page using it
+    Page& theme(ThemeHandle handle) { theme_ = handle; touch(); return *this; }
+    Page& with_sse() { include_sse_ = true; touch(); return *this; }
+
+    // Use one stylesheet holding every built-in theme and pick the theme with
+    // data-theme on <html> (the page's own theme initially), so a single
+    // render can be switched between themes without regenerating it. Only
+    // the built-in themes are in that stylesheet.
+    Page& all_themes(bool on = true) { all_themes_ = on; touch(); return *this; }
+
+    // Inline only the stylesheet rules the rendered page can use. Classes
+    // that only appear in markup added later (htmx swaps, SSE messages) must
+    // be listed with keep_classes(), space-separated.
+    Page& prune_css(bool on = true) { prune_css_ = on; touch(); return *this; }
+    Page& keep_classes(const std::string& classes) { keep_classes_ += " " + classes; touch(); return *this; }
+
+    // Inline or link the minified stylesheet; like the full one it is built
+    // once per theme
+    Page& minify_css(bool on = true) { minify_css_ = on; touch(); return *this; }
+
+    // No indentation or line breaks around the markup, the minified
+    // stylesheet and compact inline scripts. Text is left as it is. Every
+    // compact form is prepared once, so this costs nothing per render.
+    Page& compact(bool on = true) { compact_ = on; touch(); return *this; }
+
+    // Link the stylesheet as zero_js-<theme>.<hash>.css instead of inlining
+    // it, so every page of a site shares one cacheable file. href_prefix is
+    // put in front of the file name in the <link>; render_to_file() writes
+    // the file there too when the prefix is a relative path. Otherwise
+    // publish stylesheet() yourself.
+    Page& external_css(const std::string& href_prefix = "") {
+        external_css_ = true;
+        css_href_prefix_ = href_prefix;
+        touch();
+        return *this;
+    }
+
+    // Inline only the rules the first paint needs (layout, navbar, sidebar,
+    // cards and typography used by this page) and load the full stylesheet
+    // as zero_js-<theme>.<hash>.css without blocking on it. href_prefix is
+    // used as in external_css(); the web font @import moves to that file.
+    Page& critical_css(const std::string& href_prefix = "") {
+        critical_css_ = true;
+        css_href_prefix_ = href_prefix;
+        touch();
+        return *this;
+    }
+
+    // Serve the theme's font from a local TrueType file instead of importing
+    // it from Google Fonts. Each render subsets the file to the characters
+    // the page shows and links it as <file stem>.<hash>.ttf with
+    // font-display: swap; render_to_file() writes it next to the stylesheet
+    // (see external_css()), otherwise publish fonts() yourself. Call once per
+    // weight or style. Characters that only appear in markup added later
+    // go in font_text().
+    Page& self_hosted_font(const std::string& ttf_path, int weight = 400, const std::string& style = "normal") {
+        fonts_.push_back({ttf_path, weight, style});
+        touch();
+        return *this;
+    }
+    Page& font_text(const std::string& text) { font_text_ += text; touch(); return *this; }
+
+    // The subset font files this page links
+    std::vector<Asset> fonts() const;
+
+    // Adds the characters this page shows in its self-hosted fonts, which
+    // renders the body. Returns false, adding nothing, if it has none. Under
+    // a FontCharactersScope the fonts are subset to the scope's characters
+    // instead.
+    bool font_characters(std::set<char32_t>& codepoints) const;
+
+    // Link htmx (and the SSE extension) as htmx.<hash>.js and
+    // htmx-sse.<hash>.js with defer instead of inlining about 40 KB of
+    // script into every page; browsers then cache them across pages.
+    // Nothing is loaded from unpkg. href_prefix works as in external_css();
+    // otherwise publish scripts() yourself.
+    Page& external_scripts(const std::string& href_prefix = "") {
+        scripts_ = ScriptSource::External;
+        script_href_prefix_ = href_prefix;
+        touch();
+        return *this;
+    }
+    // Load the same htmx version from unpkg.com with defer
+    Page& cdn_scripts() { scripts_ = ScriptSource::Cdn; touch(); return *this; }
+    // Inline the scripts (the default); the page needs nothing else
+    Page& inline_scripts() { scripts_ = ScriptSource::Inline; touch(); return *this; }
+
+    // The script files this page links with external_scripts()
+    std::vector<Asset> scripts() const;
+
+    // Measure the whole document before render() so its string is
+    // allocated exactly once. This renders the body twice, so it only pays
+    // off for large pages of cheap components; by default the buffer is
+    // sized from the head plus an allowance and grows if the body needs it.
+    Page& exact_size(bool on = true) { exact_size_ = on; touch(); return *this; }
+
+    // The stylesheet this page inlines or links
+    Asset stylesheet() const;
+
+    // Render large child lists and charts on a thread pool. The output is
+    // byte-identical to a serial render.
+    Page& parallel(ThreadPool& pool = default_thread_pool(), size_t min_children = 8) {
+        parallel_.pool = &pool;
+        parallel_.min_children = min_children;
+        touch();
         return *this;
     }
 
-    Page& title(const std::string& t) { title_ = t; return *this; }
-    Page& no_htmx() { include_htmx_ = false; return *this; }
-    Page& dark_mode() { theme_mode_ = 0; return *this; }
-    Page& light_mode() { theme_mode_ = 1; return *this; }
-    Page& cream_mode() { theme_mode_ = 2; return *this; }
-    Page& with_sse() { include_sse_ = true; return *this; }
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
 
+    void render_to(Sink& out) const override;
     std::string render() const override;
-    std::string render_fragment() const { return render_children(children_); }
-    void render_to_file(const std::string& path) const;
+    std::string render_fragment() const {
+        StringSink out;
+        render_children(children_, out);
+        return std::move(out.str());
+    }
+    // Writes the page, and the assets it links, to temporary files renamed
+    // into place once complete (see write_file_atomic()), so a reader never
+    // sees a torn page. Returns the first error; if an asset fails, the
+    // page is not written.
+    WriteResult render_to_file(const std::string& path, SyncPolicy policy = SyncPolicy::None) const;
+    // The page is renamed into place when the batch commits, so a failure
+    // there is returned by commit() (or told to WriteOptions::committed)
+    WriteResult render_to_file(const std::string& path, SyncBatch& batch) const;
+    // Leaves the file alone when the rendered page hashes the same as when
+    // the manifest last recorded it (WriteResult::unchanged), and records
+    // the new hash once the page is in place, with a batch when it commits.
+    // The page is still rendered to be hashed.
+    WriteResult render_to_file(const std::string& path, BuildManifest& manifest,
+                               SyncPolicy policy = SyncPolicy::None) const;
+    WriteResult render_to_file(const std::string& path, BuildManifest& manifest, SyncBatch& batch) const;
+    // Any combination of the above, plus precompressed .gz and .zst copies
+    // of the page and its assets
+    WriteResult render_to_file(const std::string& path, const WriteOptions& options) const;
+    // Writes the page to a file descriptor or socket with writev(), without
+    // copying literals or component strings. Returns false on a write error.
+    bool render_to_fd(int fd) const;
 
     bool include_sse_ = false;
+
+private:
+    ParallelRender parallel_;
+    bool prune_css_ = false;
+    std::string keep_classes_;
+    bool minify_css_ = false;
+    bool compact_ = false;
+    bool external_css_ = false;
+    bool critical_css_ = false;
+    std::string css_href_prefix_;
+    enum class ScriptSource { Inline, External, Cdn };
+    ScriptSource scripts_ = ScriptSource::Inline;
+    std::string script_href_prefix_;
+    bool detect_scripts_ = true;
+    bool exact_size_ = false;
+    // Body bytes render() reserves for when it has not measured the body
+    static constexpr size_t body_allowance = 16 * 1024;
+    std::vector<FontFile> fonts_;
+    std::string font_text_;
+    bool all_themes_ = false;
+
+    // Per-render state: the body when it has to be rendered before the head,
+    // and the stylesheet for this render
+    struct Prepared {
+        std::string body;
+        bool has_body = false;
+        std::string pruned_css;
+        std::string critical_css;
+        std::vector<Asset> fonts;
+        std::string font_css;
+        std::string_view css;
+        std::string href;
+        ScriptNeeds scripts;
+        std::string htmx_src;
+        std::string sse_src;
+    };
+    void prepare(Prepared& p, bool body_first) const;
+    PageHead head(const Prepared& p) const;
+
+    ScriptNeeds needed_scripts() const;
+    bool minified() const { return minify_css_ || compact_; }
+    std::string_view base_css() const;
+    std::string css_stem() const;
+    std::string render_body() const;
+    std::unordered_set<std::string_view> used_classes(const std::string& body) const;
+    std::string used_css(const std::string& body) const;
+    std::string first_paint_css(const std::string& body) const;
+    void add_font_characters(const std::string& body, std::set<char32_t>& codepoints) const;
+    void subset_fonts(Prepared& p) const;
+    WriteResult write_files(const std::string& path, const WriteOptions& options) const;
+    void render_document(Sink& out, const Prepared& p) const;
+};
+
+// Page that owns the arena its component tree is allocated from. Build the
+// tree inside scope() and every node lands contiguously in the arena; the
+// blocks are released in one go when the document is destroyed.
+//
+// What this saves is one heap allocation per node, and it gains locality
+// when rendering. Teardown is not O(1): nodes are still reference counted,
+// every destructor still runs, and the strings and child vectors inside
+// nodes still live on the heap. Blocks are never reused while the arena
+// lives, so the arena grows with every node built into it.
+//
+//     Document doc("Report");
+//     {
+//         auto scope = doc.scope();
+//         doc.page().add(Card().title("Totals").add(Stat().value("42")));
+//     }
+//     doc.page().render_to_file("report.html");
+class Document {
+public:
+    explicit Document(const std::string& title = "", size_t block_size = 64 * 1024)
+        : arena_(block_size), page_(title) {}
+
+    ArenaScope scope() { return ArenaScope(arena_); }
+
+    Page& page() { return page_; }
+    const Page& page() const { return page_; }
+    Arena& arena() { return arena_; }
+
+private:
+    // Declared first so it outlives the page that points into it
+    Arena arena_;
+    Page page_;
 };
 
 // ============================================================================
@@ -807,24 +1558,24 @@ public:
     ChatMessage() = default;
     explicit ChatMessage(const std::string& content) : content_(content) {}
 
-    ChatMessage& content(const std::string& c) { content_ = c; return *this; }
-    ChatMessage& user() { is_user_ = true; return *this; }
-    ChatMessage& assistant() { is_user_ = false; return *this; }
-    ChatMessage& streaming() { is_streaming_ = true; return *this; }
-    ChatMessage& id(const std::string& i) { id_ = i; return *this; }
-    ChatMessage& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-chat-message";
-        if (is_user_) cls += " ew-chat-message-user";
-        else cls += " ew-chat-message-assistant";
-        if (is_streaming_) cls += " ew-chat-message-streaming";
-        if (!classes_.empty()) cls += " " + classes_;
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
-        html << "<div class=\"ew-chat-message-content\">" << content_ << "</div>";
-        html << "</div>";
-        return html.str();
+    ChatMessage& content(const std::string& c) { content_ = c; touch(); return *this; }
+    ChatMessage& user() { is_user_ = true; touch(); return *this; }
+    ChatMessage& assistant() { is_user_ = false; touch(); return *this; }
+    ChatMessage& streaming() { is_streaming_ = true; touch(); return *this; }
+    ChatMessage& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    ChatMessage& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-chat-message";
+        if (is_user_) out << " ew-chat-message-user";
+        else out << " ew-chat-message-assistant";
+        if (is_streaming_) out << " ew-chat-message-streaming";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
+        out << "<div class=\"ew-chat-message-content\">" << content_ << "</div>";
+        out << "</div>";
     }
 };
 
@@ -837,30 +1588,34 @@ public:
 
     ChatInput() = default;
 
-    ChatInput& placeholder(const std::string& p) { placeholder_ = p; return *this; }
-    ChatInput& endpoint(const std::string& e) { endpoint_ = e; return *this; }
-    ChatInput& session(const std::string& s) { session_id_ = s; return *this; }
-    ChatInput& target(const std::string& t) { target_ = t; return *this; }
-    ChatInput& id(const std::string& i) { id_ = i; return *this; }
-    ChatInput& classes(const std::string& c) { classes_ = c; return *this; }
-
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-chat-input-container";
-        if (!classes_.empty()) cls += " " + classes_;
-
-        html << "<form class=\"" << cls << "\"";
-        html << " hx-post=\"" << endpoint_ << "\"";
-        html << " hx-target=\"" << target_ << "\"";
-        html << " hx-swap=\"beforeend\"";
+    ChatInput& placeholder(const std::string& p) { placeholder_ = p; touch(); return *this; }
+    ChatInput& endpoint(const std::string& e) { endpoint_ = e; touch(); return *this; }
+    ChatInput& session(const std::string& s) { session_id_ = s; touch(); return *this; }
+    ChatInput& target(const std::string& t) { target_ = t; touch(); return *this; }
+    ChatInput& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    ChatInput& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void render_to(Sink& out) const override {
+        out << "<form class=\"ew-chat-input-container";
+        render_classes(out);
+        out << "\"";
+        out << " hx-post=\"" << endpoint_ << "\"";
+        out << " hx-target=\"" << target_ << "\"";
+        out << " hx-swap=\"beforeend\"";
         if (!session_id_.empty()) {
-            html << " hx-vals='{\"session_id\":\"" << session_id_ << "\"}'";
+            out << " hx-vals='{\"session_id\":\"" << session_id_ << "\"}'";
         }
-        html << render_attributes() << ">";
-        html << "<input type=\"text\" name=\"message\" class=\"ew-input ew-chat-input\" placeholder=\"" << placeholder_ << "\" autocomplete=\"off\">";
-        html << "<button type=\"submit\" class=\"ew-button ew-button-primary\">Send</button>";
-        html << "</form>";
-        return html.str();
+        render_attributes(out);
+        out << ">";
+        out << "<input type=\"text\" name=\"message\" class=\"ew-input ew-chat-input\" placeholder=\"" << placeholder_ << "\" autocomplete=\"off\">";
+        out << "<button type=\"submit\" class=\"ew-button ew-button-primary\">Send</button>";
+        out << "</form>";
+    }
+
+    ScriptNeeds scripts_needed() const override {
+        ScriptNeeds needs = Component::scripts_needed();
+        needs.htmx = true;
+        return needs;
     }
 };
 
@@ -877,44 +1632,49 @@ public:
     template<typename T>
     ChatStream& add(T&& component) {
         children_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    ChatStream& session(const std::string& s) { session_id_ = s; return *this; }
-    ChatStream& endpoint(const std::string& e) { endpoint_ = e; return *this; }
-    ChatStream& event(const std::string& e) { event_name_ = e; return *this; }
-    ChatStream& close_on(const std::string& e) { close_event_ = e; return *this; }
-    ChatStream& id(const std::string& i) { id_ = i; return *this; }
-    ChatStream& classes(const std::string& c) { classes_ = c; return *this; }
+    ChatStream& session(const std::string& s) { session_id_ = s; touch(); return *this; }
+    ChatStream& endpoint(const std::string& e) { endpoint_ = e; touch(); return *this; }
+    ChatStream& event(const std::string& e) { event_name_ = e; touch(); return *this; }
+    ChatStream& close_on(const std::string& e) { close_event_ = e; touch(); return *this; }
+    ChatStream& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    ChatStream& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-chat-stream";
-        if (!classes_.empty()) cls += " " + classes_;
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(children_, fn);
+    }
+
+    ScriptNeeds scripts_needed() const override { return {true, true}; }
+
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-chat-stream";
+        render_classes(out);
+        out << "\"";
+        out << " hx-ext=\"sse\"";
 
-        // Build the SSE URL
-        std::string sse_url = endpoint_;
+        // SSE URL
+        out << " sse-connect=\"" << endpoint_;
         if (!session_id_.empty()) {
-            sse_url += "?session_id=" + session_id_;
+            out << "?session_id=" << session_id_;
         }
-
-        html << "<div class=\"" << cls << "\"";
-        html << " hx-ext=\"sse\"";
-        html << " sse-connect=\"" << sse_url << "\"";
+        out << "\"";
         if (!close_event_.empty()) {
-            html << " sse-close=\"" << close_event_ << "\"";
+            out << " sse-close=\"" << close_event_ << "\"";
         }
-        html << render_attributes() << ">";
+        render_attributes(out);
+        out << ">";
 
         // Inner div that receives the streamed content
-        html << "<div class=\"ew-chat-stream-content\"";
-        html << " sse-swap=\"" << event_name_ << "\"";
-        html << " hx-swap=\"beforeend\">";
-        html << render_children(children_);
-        html << "</div>";
+        out << "<div class=\"ew-chat-stream-content\"";
+        out << " sse-swap=\"" << event_name_ << "\"";
+        out << " hx-swap=\"beforeend\">";
+        render_children(children_, out);
+        out << "</div>";
 
-        html << "</div>";
-        return html.str();
+        out << "</div>";
     }
 };
 
@@ -931,56 +1691,62 @@ public:
     template<typename T>
     ChatContainer& add_message(T&& component) {
         initial_messages_.push_back(make_component(std::forward<T>(component)));
+        touch();
         return *this;
     }
 
-    ChatContainer& session(const std::string& s) { session_id_ = s; return *this; }
-    ChatContainer& chat_endpoint(const std::string& e) { chat_endpoint_ = e; return *this; }
-    ChatContainer& stream_endpoint(const std::string& e) { stream_endpoint_ = e; return *this; }
-    ChatContainer& placeholder(const std::string& p) { placeholder_ = p; return *this; }
-    ChatContainer& id(const std::string& i) { id_ = i; return *this; }
-    ChatContainer& classes(const std::string& c) { classes_ = c; return *this; }
+    ChatContainer& session(const std::string& s) { session_id_ = s; touch(); return *this; }
+    ChatContainer& chat_endpoint(const std::string& e) { chat_endpoint_ = e; touch(); return *this; }
+    ChatContainer& stream_endpoint(const std::string& e) { stream_endpoint_ = e; touch(); return *this; }
+    ChatContainer& placeholder(const std::string& p) { placeholder_ = p; touch(); return *this; }
+    ChatContainer& id(const std::string& i) { set_attr(Attr::Id, i); return *this; }
+    ChatContainer& classes(const std::string& c) { set_attr(Attr::Classes, c); return *this; }
+
+    void for_each_child(const std::function<void(const Component&)>& fn) const override {
+        visit(initial_messages_, fn);
+    }
 
-    std::string render() const override {
-        std::ostringstream html;
-        std::string cls = "ew-chat-container";
-        if (!classes_.empty()) cls += " " + classes_;
+    ScriptNeeds scripts_needed() const override { return {true, true}; }
 
-        html << "<div class=\"" << cls << "\"" << render_attributes() << ">";
+    void render_to(Sink& out) const override {
+        out << "<div class=\"ew-chat-container";
+        render_classes(out);
+        out << "\"";
+        render_attributes(out);
+        out << ">";
 
         // Messages area with SSE streaming
-        html << "<div class=\"ew-chat-messages\" id=\"chat-messages\"";
-        html << " hx-ext=\"sse\"";
-        std::string sse_url = stream_endpoint_;
+        out << "<div class=\"ew-chat-messages\" id=\"chat-messages\"";
+        out << " hx-ext=\"sse\"";
+        out << " sse-connect=\"" << stream_endpoint_;
         if (!session_id_.empty()) {
-            sse_url += "?session_id=" + session_id_;
+            out << "?session_id=" << session_id_;
         }
-        html << " sse-connect=\"" << sse_url << "\"";
-        html << " sse-close=\"done\">";
+        out << "\"";
+        out << " sse-close=\"done\">";
 
         // Initial messages
-        html << render_children(initial_messages_);
+        render_children(initial_messages_, out);
 
         // Response area for streamed content
-        html << "<div id=\"chat-response\" sse-swap=\"message\" hx-swap=\"beforeend\"></div>";
+        out << "<div id=\"chat-response\" sse-swap=\"message\" hx-swap=\"beforeend\"></div>";
 
-        html << "</div>";
+        out << "</div>";
 
         // Input form
-        html << "<form class=\"ew-chat-input-container\"";
-        html << " hx-post=\"" << chat_endpoint_ << "\"";
-        html << " hx-target=\"#chat-response\"";
-        html << " hx-swap=\"beforeend\"";
+        out << "<form class=\"ew-chat-input-container\"";
+        out << " hx-post=\"" << chat_endpoint_ << "\"";
+        out << " hx-target=\"#chat-response\"";
+        out << " hx-swap=\"beforeend\"";
         if (!session_id_.empty()) {
-            html << " hx-vals='{\"session_id\":\"" << session_id_ << "\"}'";
+            out << " hx-vals='{\"session_id\":\"" << session_id_ << "\"}'";
         }
-        html << ">";
-        html << "<input type=\"text\" name=\"message\" class=\"ew-input ew-chat-input\" placeholder=\"" << placeholder_ << "\" autocomplete=\"off\">";
-        html << "<button type=\"submit\" class=\"ew-button ew-button-primary\">Send</button>";
-        html << "</form>";
+        out << ">";
+        out << "<input type=\"text\" name=\"message\" class=\"ew-input ew-chat-input\" placeholder=\"" << placeholder_ << "\" autocomplete=\"off\">";
+        out << "<button type=\"submit\" class=\"ew-button ew-button-primary\">Send</button>";
+        out << "</form>";
 
-        html << "</div>";
-        return html.str();
+        out << "</div>";
     }
 };
 
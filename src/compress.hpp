@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "output.hpp"
+
+// Precompressed siblings need the compression libraries, which are opt-in so
+// that the library stays header-only without them: define ZERO_JS_WITH_ZLIB
+// and link zlib for .gz files, ZERO_JS_WITH_ZSTD and link libzstd for .zst
+// files (the CMake options ZEROJS_WITH_ZLIB and ZEROJS_WITH_ZSTD do both).
+#ifdef ZERO_JS_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ZERO_JS_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace zero_js
+{
+
+// ============================================================================
+// Precompressed Output
+// ============================================================================
+
+namespace compress_detail
+{
+    // Each compressor streams over the pieces (e.g. a SegmentSink's iovecs),
+    // so the content is never joined first. They return 0, ENOTSUP when the
+    // library is not built in, or EINVAL for a level it rejects.
+
+    inline int gzip(const iovec* pieces, size_t count, int level, std::string& out) {
+#ifdef ZERO_JS_WITH_ZLIB
+        z_stream z{};
+        // 15 + 16: largest window, gzip header instead of zlib's
+        if (deflateInit2(&z, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return EINVAL;
+        uLong total = 0;
+        for (size_t i = 0; i < count; ++i) total += static_cast<uLong>(pieces[i].iov_len);
+        out.resize(deflateBound(&z, total));
+        z.next_out = reinterpret_cast<Bytef*>(out.data());
+        z.avail_out = static_cast<uInt>(out.size());
+        auto grow = [&z, &out] {
+            size_t used = out.size() - z.avail_out;
+            out.resize(out.size() * 2);
+            z.next_out = reinterpret_cast<Bytef*>(out.data()) + used;
+            z.avail_out = static_cast<uInt>(out.size() - used);
+        };
+
+        int status = Z_OK;
+        for (size_t i = 0; i < count && status == Z_OK; ++i) {
+            z.next_in = static_cast<Bytef*>(pieces[i].iov_base);
+            z.avail_in = static_cast<uInt>(pieces[i].iov_len);
+            while (z.avail_in > 0 && status == Z_OK) {
+                if (z.avail_out == 0) grow();
+                status = deflate(&z, Z_NO_FLUSH);
+            }
+        }
+        while (status == Z_OK) {
+            if (z.avail_out == 0) grow();
+            status = deflate(&z, Z_FINISH);
+            if (status == Z_BUF_ERROR) status = Z_OK;
+        }
+        out.resize(z.total_out);
+        deflateEnd(&z);
+        return status == Z_STREAM_END ? 0 : EINVAL;
+#else
+        (void)pieces; (void)count; (void)level; (void)out;
+        return ENOTSUP;
+#endif
+    }
+
+    inline int zstd(const iovec* pieces, size_t count, int level, std::string& out) {
+#ifdef ZERO_JS_WITH_ZSTD
+        ZSTD_CCtx* cctx = ZSTD_createCCtx();
+        if (!cctx) return ENOMEM;
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) total += pieces[i].iov_len;
+        bool ok = !ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level)) &&
+                  !ZSTD_isError(ZSTD_CCtx_setPledgedSrcSize(cctx, total));
+        out.resize(ZSTD_compressBound(total));
+        ZSTD_outBuffer output{out.data(), out.size(), 0};
+        auto grow = [&output, &out] {
+            out.resize(out.size() * 2);
+            output.dst = out.data();
+            output.size = out.size();
+        };
+
+        for (size_t i = 0; i < count && ok; ++i) {
+            ZSTD_inBuffer input{pieces[i].iov_base, pieces[i].iov_len, 0};
+            while (input.pos < input.size && ok) {
+                if (output.pos == output.size) grow();
+                ok = !ZSTD_isError(ZSTD_compressStream2(cctx, &output, &input, ZSTD_e_continue));
+            }
+        }
+        while (ok) {
+            if (output.pos == output.size) grow();
+            ZSTD_inBuffer none{nullptr, 0, 0};
+            size_t left = ZSTD_compressStream2(cctx, &output, &none, ZSTD_e_end);
+            ok = !ZSTD_isError(left);
+            if (left == 0) break;
+        }
+        out.resize(output.pos);
+        ZSTD_freeCCtx(cctx);
+        return ok ? 0 : EINVAL;
+#else
+        (void)pieces; (void)count; (void)level; (void)out;
+        return ENOTSUP;
+#endif
+    }
+
+    inline bool exists(const std::string& path) { return ::access(path.c_str(), F_OK) == 0; }
+}
+
+// True if every sibling the settings ask for is already next to path
+inline bool precompressed_present(const std::string& path, const Precompress& precompress) {
+    return (precompress.gzip <= 0 || compress_detail::exists(path + ".gz")) &&
+           (precompress.zstd <= 0 || compress_detail::exists(path + ".zst"));
+}
+
+// Compresses the pieces into <path>.gz and <path>.zst as precompress asks
+// and stages each in a temporary next to it, appended to staged; nothing is
+// renamed yet. When only_missing is set, siblings already there are skipped
+// (for content-hashed files, whose siblings never change). Returns the first
+// failure; the siblings that did not fail are staged regardless.
+inline WriteResult stage_precompressed(const std::string& path, const iovec* pieces, size_t count,
+                                       const Precompress& precompress, std::vector<StagedFile>& staged,
+                                       bool only_missing = false) {
+    struct Format {
+        const char* ext;
+        const char* step;
+        int level;
+        int (*compress)(const iovec*, size_t, int, std::string&);
+    };
+    const Format formats[] = {
+        {".gz", "gzip", precompress.gzip, compress_detail::gzip},
+        {".zst", "zstd", precompress.zstd, compress_detail::zstd},
+    };
+
+    WriteResult result;
+    std::string packed;
+    for (const Format& format : formats) {
+        if (format.level <= 0) continue;
+        std::string sibling = path + format.ext;
+        if (only_missing && compress_detail::exists(sibling)) continue;
+        int error = format.compress(pieces, count, format.level, packed);
+        StagedFile file;
+        WriteResult written = error ? output_detail::failure(format.step, error)
+                                    : output_detail::stage(sibling, std::string_view(packed), file);
+        if (written) staged.push_back(std::move(file));
+        else if (result) result = written;
+    }
+    return result;
+}
+
+// Writes <path>.gz and <path>.zst as options.precompress asks, holding the
+// pieces compressed, in the same atomic way as the file itself. Each is
+// renamed into place on its own; see stage_precompressed() for only_missing.
+inline WriteResult write_precompressed(const std::string& path, const iovec* pieces, size_t count,
+                                       const WriteOptions& options, bool only_missing = false) {
+    std::vector<StagedFile> staged;
+    WriteResult result = stage_precompressed(path, pieces, count, options.precompress, staged, only_missing);
+    for (StagedFile& file : staged) {
+        if (options.batch) {
+            options.batch->add(std::move(file));
+            continue;
+        }
+        WriteResult written = output_detail::publish(file, options.sync);
+        if (result && !written) result = written;
+    }
+    return result;
+}
+
+inline WriteResult write_precompressed(const std::string& path, std::string_view content,
+                                       const WriteOptions& options, bool only_missing = false) {
+    iovec piece{const_cast<char*>(content.data()), content.size()};
+    return write_precompressed(path, &piece, 1, options, only_missing);
+}
+
+}
@@ -0,0 +1,559 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "assets.hpp"
+#include "scan.hpp"
+
+namespace zero_js
+{
+
+// ============================================================================
+// Self-Hosted Fonts
+// ============================================================================
+
+namespace font_detail
+{
+    inline uint32_t tag(const char (&name)[5]) {
+        return uint32_t(uint8_t(name[0])) << 24 | uint32_t(uint8_t(name[1])) << 16 |
+               uint32_t(uint8_t(name[2])) << 8 | uint32_t(uint8_t(name[3]));
+    }
+
+    inline uint16_t u16(std::string_view data, size_t at) {
+        if (at + 2 > data.size()) return 0;
+        return uint16_t(uint8_t(data[at]) << 8 | uint8_t(data[at + 1]));
+    }
+
+    inline uint32_t u32(std::string_view data, size_t at) {
+        if (at + 4 > data.size()) return 0;
+        return uint32_t(u16(data, at)) << 16 | u16(data, at + 2);
+    }
+
+    inline void put16(std::string& out, uint16_t v) {
+        out += char(v >> 8);
+        out += char(v);
+    }
+
+    inline void put32(std::string& out, uint32_t v) {
+        put16(out, uint16_t(v >> 16));
+        put16(out, uint16_t(v));
+    }
+
+    inline void set32(std::string& out, size_t at, uint32_t v) {
+        out[at] = char(v >> 24);
+        out[at + 1] = char(v >> 16);
+        out[at + 2] = char(v >> 8);
+        out[at + 3] = char(v);
+    }
+
+    // Sum of big-endian 32-bit words, the last one zero-padded
+    inline uint32_t checksum(std::string_view data) {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < data.size(); i += 4) {
+            uint32_t word = 0;
+            for (size_t j = 0; j < 4; ++j) {
+                word = word << 8 | (i + j < data.size() ? uint8_t(data[i + j]) : 0);
+            }
+            sum += word;
+        }
+        return sum;
+    }
+
+    struct Table {
+        uint32_t tag;
+        std::string_view data;
+    };
+
+    inline bool read_tables(std::string_view font, std::vector<Table>& tables) {
+        uint32_t version = u32(font, 0);
+        if (version != 0x00010000 && version != tag("true")) return false;   // TrueType outlines only
+        uint16_t count = u16(font, 4);
+        if (12 + size_t(count) * 16 > font.size()) return false;
+        for (uint16_t i = 0; i < count; ++i) {
+            size_t record = 12 + size_t(i) * 16;
+            uint32_t offset = u32(font, record + 8), length = u32(font, record + 12);
+            if (size_t(offset) + length > font.size()) return false;
+            tables.push_back({u32(font, record), font.substr(offset, length)});
+        }
+        return true;
+    }
+
+    inline std::string_view find_table(const std::vector<Table>& tables, uint32_t name) {
+        for (const Table& t : tables) {
+            if (t.tag == name) return t.data;
+        }
+        return {};
+    }
+
+    // Glyph ids of the code points, from a Unicode cmap subtable (format 12
+    // preferred, format 4 otherwise). Unmapped code points are skipped.
+    inline void map_glyphs(std::string_view cmap, const std::set<char32_t>& codepoints, std::set<uint16_t>& glyphs) {
+        std::string_view format4, format12;
+        uint16_t count = u16(cmap, 2);
+        for (uint16_t i = 0; i < count; ++i) {
+            uint16_t platform = u16(cmap, 4 + i * 8), encoding = u16(cmap, 6 + i * 8);
+            uint32_t offset = u32(cmap, 8 + i * 8);
+            bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+            if (!unicode || offset >= cmap.size()) continue;
+            std::string_view sub = cmap.substr(offset);
+            uint16_t format = u16(sub, 0);
+            if (format == 12 && format12.empty()) format12 = sub.substr(0, std::min<size_t>(sub.size(), u32(sub, 4)));
+            if (format == 4 && format4.empty()) format4 = sub.substr(0, std::min<size_t>(sub.size(), u16(sub, 2)));
+        }
+
+        if (!format12.empty()) {
+            uint32_t groups = u32(format12, 12);
+            for (char32_t c : codepoints) {
+                for (uint32_t g = 0; g < groups; ++g) {
+                    size_t at = 16 + size_t(g) * 12;
+                    uint32_t start = u32(format12, at), end = u32(format12, at + 4);
+                    if (c >= start && c <= end) {
+                        glyphs.insert(uint16_t(u32(format12, at + 8) + (c - start)));
+                        break;
+                    }
+                }
+            }
+            return;
+        }
+        if (format4.empty()) return;
+
+        uint16_t segments = u16(format4, 6) / 2;
+        size_t ends = 14, starts = ends + segments * 2 + 2;
+        size_t deltas = starts + segments * 2, range_offsets = deltas + segments * 2;
+        for (char32_t c : codepoints) {
+            if (c > 0xFFFF) continue;
+            for (uint16_t s = 0; s < segments; ++s) {
+                if (c > u16(format4, ends + s * 2)) continue;
+                uint16_t start = u16(format4, starts + s * 2);
+                if (c < start) break;
+                uint16_t delta = u16(format4, deltas + s * 2);
+                uint16_t range_offset = u16(format4, range_offsets + s * 2);
+                uint16_t glyph;
+                if (range_offset == 0) {
+                    glyph = uint16_t(c + delta);
+                } else {
+                    glyph = u16(format4, range_offsets + s * 2 + range_offset + (c - start) * 2);
+                    if (glyph != 0) glyph = uint16_t(glyph + delta);
+                }
+                if (glyph != 0) glyphs.insert(glyph);
+                break;
+            }
+        }
+    }
+
+    // Adds the glyphs that composite glyphs among them are built from
+    inline void add_components(std::string_view glyf, const std::vector<uint32_t>& loca, std::set<uint16_t>& glyphs) {
+        std::vector<uint16_t> pending(glyphs.begin(), glyphs.end());
+        while (!pending.empty()) {
+            uint16_t g = pending.back();
+            pending.pop_back();
+            if (size_t(g) + 1 >= loca.size() || loca[g] >= loca[g + 1]) continue;
+            std::string_view glyph = glyf.substr(std::min<size_t>(loca[g], glyf.size()), loca[g + 1] - loca[g]);
+            if (int16_t(u16(glyph, 0)) >= 0) continue;   // simple glyph
+
+            size_t at = 10;
+            for (;;) {
+                uint16_t flags = u16(glyph, at), component = u16(glyph, at + 2);
+                if (at + 4 > glyph.size()) break;
+                if (glyphs.insert(component).second) pending.push_back(component);
+                at += 4 + ((flags & 0x0001) ? 4 : 2);
+                if (flags & 0x0008) at += 2;
+                else if (flags & 0x0040) at += 4;
+                else if (flags & 0x0080) at += 8;
+                if (!(flags & 0x0020)) break;
+            }
+        }
+    }
+
+    // The glyphs an OpenType coverage table lists, in coverage index order
+    inline std::vector<uint16_t> coverage_glyphs(std::string_view coverage) {
+        std::vector<uint16_t> glyphs;
+        uint16_t format = u16(coverage, 0), count = u16(coverage, 2);
+        for (uint16_t i = 0; i < count; ++i) {
+            if (format == 1) {
+                if (size_t(4) + i * 2 + 2 > coverage.size()) break;
+                glyphs.push_back(u16(coverage, 4 + i * 2));
+            } else if (format == 2) {
+                size_t at = 4 + size_t(i) * 6;
+                if (at + 6 > coverage.size()) break;
+                for (uint32_t g = u16(coverage, at); g <= u16(coverage, at + 2); ++g) glyphs.push_back(uint16_t(g));
+            }
+        }
+        return glyphs;
+    }
+
+    // Adds every glyph a GSUB lookup can put in place of kept glyphs:
+    // single, multiple and alternate substitutes, ligatures whose
+    // components are all kept, and reverse chaining substitutes. Each
+    // lookup is followed whether or not its feature or context applies, so
+    // the set may be larger than needed but never misses a glyph a browser
+    // substitutes. Repeats until nothing is added, for lookups that feed
+    // each other.
+    inline void add_substitutes(std::string_view gsub, std::set<uint16_t>& glyphs) {
+        if (gsub.size() < 10) return;
+        std::string_view lookups = gsub.substr(std::min<size_t>(u16(gsub, 8), gsub.size()));
+        auto at = [](std::string_view data, size_t offset) {
+            return data.substr(std::min(offset, data.size()));
+        };
+        for (size_t before = 0; before != glyphs.size();) {
+            before = glyphs.size();
+            for (uint16_t l = 0, count = u16(lookups, 0); l < count; ++l) {
+                std::string_view lookup = at(lookups, u16(lookups, 2 + l * 2));
+                for (uint16_t s = 0, subtables = u16(lookup, 4); s < subtables; ++s) {
+                    uint16_t type = u16(lookup, 0);
+                    std::string_view sub = at(lookup, u16(lookup, 6 + s * 2));
+                    if (type == 7) {   // extension: the real subtable is elsewhere
+                        type = u16(sub, 2);
+                        sub = at(sub, u32(sub, 4));
+                    }
+                    if (type == 0 || (type > 4 && type != 8)) continue;   // contexts only call other lookups
+                    std::vector<uint16_t> covered = coverage_glyphs(at(sub, u16(sub, 2)));
+                    for (size_t i = 0; i < covered.size(); ++i) {
+                        if (!glyphs.count(covered[i])) continue;
+                        if (type == 1 && u16(sub, 0) == 1) {
+                            glyphs.insert(uint16_t(covered[i] + u16(sub, 4)));
+                        } else if (type == 1 && u16(sub, 0) == 2) {
+                            if (i < u16(sub, 4)) glyphs.insert(u16(sub, 6 + i * 2));
+                        } else if (type == 2 || type == 3) {
+                            if (i >= u16(sub, 4)) continue;
+                            std::string_view sequence = at(sub, u16(sub, 6 + i * 2));
+                            for (uint16_t g = 0, n = u16(sequence, 0); g < n; ++g) glyphs.insert(u16(sequence, 2 + g * 2));
+                        } else if (type == 4) {
+                            if (i >= u16(sub, 4)) continue;
+                            std::string_view set = at(sub, u16(sub, 6 + i * 2));
+                            for (uint16_t k = 0, n = u16(set, 0); k < n; ++k) {
+                                std::string_view ligature = at(set, u16(set, 2 + k * 2));
+                                uint16_t components = u16(ligature, 2);
+                                bool all = components > 0;
+                                for (uint16_t c = 1; c < components && all; ++c) all = glyphs.count(u16(ligature, 2 + c * 2)) > 0;
+                                if (all) glyphs.insert(u16(ligature, 0));
+                            }
+                        } else if (type == 8) {
+                            size_t skip = 4 + size_t(u16(sub, 4)) * 2;
+                            skip += 2 + size_t(u16(sub, skip)) * 2;
+                            if (i < u16(sub, skip)) glyphs.insert(u16(sub, skip + 2 + i * 2));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A version 0 kern table with only the format 0 pairs between kept
+    // glyphs; other versions and formats are copied as they are
+    inline std::string subset_kern(std::string_view kern, const std::set<uint16_t>& glyphs) {
+        if (u16(kern, 0) != 0) return std::string(kern);
+        std::string out;
+        put16(out, 0);
+        put16(out, u16(kern, 2));
+        size_t at = 4;
+        for (uint16_t t = 0, count = u16(kern, 2); t < count && at + 6 <= kern.size(); ++t) {
+            uint16_t length = u16(kern, at + 2), coverage = u16(kern, at + 4);
+            std::string_view sub = kern.substr(at, std::min<size_t>(length, kern.size() - at));
+            at += length;
+            if ((coverage >> 8) != 0) {
+                out.append(sub);
+                continue;
+            }
+            std::string pairs;
+            for (size_t p = 14; p + 6 <= sub.size(); p += 6) {
+                if (glyphs.count(u16(sub, p)) && glyphs.count(u16(sub, p + 2))) pairs.append(sub.substr(p, 6));
+            }
+            uint16_t n = uint16_t(pairs.size() / 6), power = 1, log2 = 0;
+            while (power * 2 <= n) { power *= 2; ++log2; }
+            put16(out, u16(sub, 0));
+            put16(out, uint16_t(14 + pairs.size()));
+            put16(out, coverage);
+            put16(out, n);
+            put16(out, uint16_t(power * 6));
+            put16(out, log2);
+            put16(out, uint16_t((n - power) * 6));
+            out.append(pairs);
+        }
+        return out;
+    }
+
+    // The font file's bytes, read once per process. Empty if it cannot be read.
+    inline std::shared_ptr<const std::string> load_file(const std::string& path) {
+        static std::mutex mutex;
+        static std::map<std::string, std::shared_ptr<const std::string>> files;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& file = files[path];
+        if (!file) {
+            std::ifstream in(path, std::ios::binary);
+            file = std::make_shared<const std::string>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        return file;
+    }
+
+    inline void add_utf8(std::string_view text, std::set<char32_t>& codepoints) {
+        for (size_t i = 0; i < text.size();) {
+            unsigned char c = uint8_t(text[i]);
+            size_t extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : 4;
+            if (extra == 4) { ++i; continue; }   // not a lead byte
+            if (i + extra >= text.size() && extra) break;
+            char32_t cp = extra == 0 ? c : c & (0x3F >> extra);
+            for (size_t j = 1; j <= extra; ++j) cp = cp << 6 | (uint8_t(text[i + j]) & 0x3F);
+            if (cp >= 0x20) codepoints.insert(cp);   // not control characters
+            i += extra + 1;
+        }
+    }
+}
+
+// Copy of a TrueType font that keeps only the outlines of the glyphs needed
+// for the given code points, plus .notdef, every glyph GSUB can substitute
+// for them (ligatures, alternates) and the parts of composite glyphs. Glyph
+// ids do not change, so cmap, hmtx and the OpenType layout tables are kept
+// as they are and every other glyph is left empty; the glyf table is usually
+// most of the file. Apple's morx is dropped, as its substitutions are not
+// followed. Returns an empty string for fonts this cannot handle (CFF
+// outlines, collections, damaged files).
+inline std::string subset_ttf(std::string_view font, const std::set<char32_t>& codepoints) {
+    using namespace font_detail;
+    std::vector<Table> tables;
+    if (!read_tables(font, tables)) return {};
+    std::string_view head = find_table(tables, tag("head")), maxp = find_table(tables, tag("maxp"));
+    std::string_view loca_table = find_table(tables, tag("loca")), glyf = find_table(tables, tag("glyf"));
+    std::string_view cmap = find_table(tables, tag("cmap"));
+    if (head.size() < 54 || maxp.size() < 6 || loca_table.empty() || glyf.empty() || cmap.empty()) return {};
+
+    uint16_t glyph_count = u16(maxp, 4);
+    bool long_offsets = u16(head, 50) == 1;
+    std::vector<uint32_t> loca(size_t(glyph_count) + 1);
+    for (size_t g = 0; g < loca.size(); ++g) {
+        loca[g] = long_offsets ? u32(loca_table, g * 4) : uint32_t(u16(loca_table, g * 2)) * 2;
+    }
+
+    std::set<uint16_t> keep = {0};
+    map_glyphs(cmap, codepoints, keep);
+    add_substitutes(find_table(tables, tag("GSUB")), keep);
+    add_components(glyf, loca, keep);
+
+    // New glyf and loca (long offsets), four-byte aligned glyphs
+    std::string new_glyf, new_loca;
+    for (uint16_t g = 0; g < glyph_count; ++g) {
+        put32(new_loca, uint32_t(new_glyf.size()));
+        if (keep.count(g) && loca[g] < loca[g + 1] && loca[g + 1] <= glyf.size()) {
+            new_glyf.append(glyf.substr(loca[g], loca[g + 1] - loca[g]));
+            new_glyf.resize((new_glyf.size() + 3) & ~size_t(3), '\0');
+        }
+    }
+    put32(new_loca, uint32_t(new_glyf.size()));
+    std::string new_head(head);
+    new_head[50] = 0;
+    new_head[51] = 1;
+    set32(new_head, 8, 0);   // checkSumAdjustment, set below
+    std::string new_kern = subset_kern(find_table(tables, tag("kern")), keep);
+    // post without glyph names (version 3)
+    std::string new_post(find_table(tables, tag("post")).substr(0, 32));
+    if (new_post.size() == 32) set32(new_post, 0, 0x00030000);
+
+    // Tables sorted by tag; DSIG would no longer match the file, and morx
+    // could substitute glyphs that were emptied
+    std::vector<std::pair<uint32_t, std::string_view>> out_tables;
+    for (const Table& t : tables) {
+        if (t.tag == tag("DSIG") || t.tag == tag("morx")) continue;
+        std::string_view data = t.data;
+        if (t.tag == tag("glyf")) data = new_glyf;
+        else if (t.tag == tag("loca")) data = new_loca;
+        else if (t.tag == tag("head")) data = new_head;
+        else if (t.tag == tag("kern")) data = new_kern;
+        else if (t.tag == tag("post") && new_post.size() == 32) data = new_post;
+        out_tables.emplace_back(t.tag, data);
+    }
+    std::sort(out_tables.begin(), out_tables.end());
+
+    uint16_t count = uint16_t(out_tables.size());
+    uint16_t power = 1, log2 = 0;
+    while (power * 2 <= count) { power *= 2; ++log2; }
+
+    std::string out;
+    put32(out, 0x00010000);
+    put16(out, count);
+    put16(out, uint16_t(power * 16));
+    put16(out, log2);
+    put16(out, uint16_t(count * 16 - power * 16));
+    size_t offset = 12 + size_t(count) * 16;
+    for (const auto& [name, data] : out_tables) {
+        put32(out, name);
+        put32(out, checksum(data));
+        put32(out, uint32_t(offset));
+        put32(out, uint32_t(data.size()));
+        offset += (data.size() + 3) & ~size_t(3);
+    }
+    size_t head_at = 0;
+    for (const auto& [name, data] : out_tables) {
+        if (name == tag("head")) head_at = out.size();
+        out.append(data);
+        out.resize((out.size() + 3) & ~size_t(3), '\0');
+    }
+    set32(out, head_at + 8, 0xB1B0AFBA - checksum(out));
+    return out;
+}
+
+// Adds the code points of some text, decoding UTF-8 and HTML character
+// references
+inline void add_codepoints(std::string_view text, std::set<char32_t>& codepoints) {
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t amp = text.find('&', i);
+        font_detail::add_utf8(text.substr(i, amp == std::string_view::npos ? std::string_view::npos : amp - i), codepoints);
+        if (amp == std::string_view::npos) break;
+        size_t semi = text.find(';', amp);
+        if (semi == std::string_view::npos || semi - amp > 10) {
+            codepoints.insert('&');
+            i = amp + 1;
+            continue;
+        }
+        std::string_view name = text.substr(amp + 1, semi - amp - 1);
+        char32_t cp = 0;
+        if (!name.empty() && name[0] == '#') {
+            bool hex = name.size() > 1 && (name[1] == 'x' || name[1] == 'X');
+            for (char c : name.substr(hex ? 2 : 1)) {
+                int digit = c >= '0' && c <= '9' ? c - '0' : hex && c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+                            hex && c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                if (digit < 0) break;
+                cp = cp * (hex ? 16 : 10) + char32_t(digit);
+            }
+        }
+        else if (name == "amp") cp = '&';
+        else if (name == "lt") cp = '<';
+        else if (name == "gt") cp = '>';
+        else if (name == "quot") cp = '"';
+        else if (name == "apos") cp = '\'';
+        else if (name == "nbsp") cp = 0xA0;
+        if (cp == 0) {
+            // Not a reference we know: a literal '&'
+            codepoints.insert('&');
+            i = amp + 1;
+            continue;
+        }
+        codepoints.insert(cp);
+        i = semi + 1;
+    }
+}
+
+// The characters a rendered page shows: its text, and the placeholder and
+// value attributes of form fields
+inline void collect_codepoints(std::string_view html, std::set<char32_t>& codepoints) {
+    for_each_text(html, [&codepoints](std::string_view text) { add_codepoints(text, codepoints); });
+    for_each_attribute(html, [&codepoints](std::string_view, std::string_view name, std::string_view value) {
+        if (name == "placeholder" || name == "value") add_codepoints(value, codepoints);
+    });
+}
+
+// A local TrueType file to serve instead of the web font
+struct FontFile {
+    std::string path;
+    int weight = 400;
+    std::string style = "normal";
+};
+
+// The characters pages on this thread subset their self-hosted fonts to
+// instead of their own, if set
+inline const std::set<char32_t>*& current_font_characters() {
+    thread_local const std::set<char32_t>* codepoints = nullptr;
+    return codepoints;
+}
+
+// Makes every page rendered on this thread subset its fonts to the same
+// characters for the lifetime of the scope, so they all link the same font
+// files; Site uses it with the characters of all its pages. Scopes nest.
+class FontCharactersScope {
+public:
+    explicit FontCharactersScope(const std::set<char32_t>& codepoints) : previous_(current_font_characters()) {
+        current_font_characters() = &codepoints;
+    }
+    ~FontCharactersScope() { current_font_characters() = previous_; }
+
+    FontCharactersScope(const FontCharactersScope&) = delete;
+    FontCharactersScope& operator=(const FontCharactersScope&) = delete;
+
+private:
+    const std::set<char32_t>* previous_;
+};
+
+// The font subset to the code points as <file stem>.<hash>.ttf, cached by
+// file and character set. The cache keeps the most recent max_cached_subsets
+// subsets, so rendering many pages that each have their own characters does
+// not grow it without end. Empty if the file cannot be read or subset.
+inline constexpr size_t max_cached_subsets = 32;
+
+inline Asset font_asset(const FontFile& font, const std::set<char32_t>& codepoints) {
+    static std::mutex mutex;
+    static std::map<std::string, Asset> subsets;
+    static std::deque<std::string> order;   // keys, oldest first
+
+    std::string key = font.path;
+    key += '\0';
+    for (char32_t c : codepoints) key.append(reinterpret_cast<const char*>(&c), sizeof(c));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = subsets.find(key);
+        if (found != subsets.end()) return found->second;
+    }
+
+    Asset asset;
+    std::shared_ptr<const std::string> file = font_detail::load_file(font.path);
+    std::string subset = subset_ttf(*file, codepoints);
+    if (!subset.empty()) {
+        size_t slash = font.path.find_last_of('/');
+        std::string stem = font.path.substr(slash == std::string::npos ? 0 : slash + 1);
+        size_t dot = stem.rfind('.');
+        if (dot != std::string::npos) stem.resize(dot);
+        asset = make_asset(stem, "ttf", std::move(subset));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (subsets.emplace(key, asset).second) {
+        order.push_back(std::move(key));
+        if (order.size() > max_cached_subsets) {
+            subsets.erase(order.front());
+            order.pop_front();
+        }
+    }
+    return asset;
+}
+
+// An @font-face rule for a subset font. unicode-range lists the code points
+// it covers, so anything else falls through to the next font in the stack.
+inline std::string font_face_css(std::string_view family, std::string_view href, const FontFile& font,
+                                 const std::set<char32_t>& codepoints, bool minify = false) {
+    auto hex = [](char32_t cp) {
+        static constexpr char digits[] = "0123456789ABCDEF";
+        std::string out;
+        do { out.insert(out.begin(), digits[cp & 0xF]); cp >>= 4; } while (cp);
+        return out;
+    };
+    std::string ranges;
+    for (auto it = codepoints.begin(); it != codepoints.end();) {
+        char32_t first = *it, last = first;
+        while (++it != codepoints.end() && *it == last + 1) last = *it;
+        if (!ranges.empty()) ranges += minify ? "," : ", ";
+        ranges += "U+" + hex(first);
+        if (last != first) ranges += "-" + hex(last);
+    }
+
+    const char* sep = minify ? ":" : ": ";
+    const char* end = minify ? ";" : ";\n    ";
+    std::string css = minify ? "@font-face{" : "@font-face {\n    ";
+    css.append("font-family").append(sep).append(family).append(end);
+    css.append("src").append(sep).append("url('").append(href).append("') format('truetype')").append(end);
+    css.append("font-weight").append(sep).append(std::to_string(font.weight)).append(end);
+    css.append("font-style").append(sep).append(font.style).append(end);
+    css.append("font-display").append(sep).append("swap").append(end);
+    css.append("unicode-range").append(sep).append(ranges);
+    css.append(minify ? "}" : ";\n}\n");
+    return css;
+}
+
+}
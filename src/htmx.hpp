@@ -1,21 +1,35 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 namespace zero_js
 {
 
     // HTMX 1.9.10 minified - https://htmx.org
     // MIT License
-    inline std::string get_htmx_script() {
+    // Views into static storage, so rendering never copies the scripts
+    inline std::string_view htmx_script_view() {
         return R"HTMX(
     var htmx=function(){"use strict";var Q={onLoad:t,process:Kt,on:le,off:ue,trigger:ie,ajax:Mr,find:C,findAll:R,closest:g,values:function(e,t){var r=Zt(e,t||"post");return r.values},remove:B,addClass:j,removeClass:V,toggleClass:U,takeClass:_,defineExtension:Cr,removeExtension:Rr,logAll:z,logNone:K,logger:null,config:{historyEnabled:!0,historyCacheSize:10,refreshOnHistoryMiss:!1,defaultSwapStyle:"innerHTML",defaultSwapDelay:0,defaultSettleDelay:20,includeIndicatorStyles:!0,indicatorClass:"htmx-indicator",requestClass:"htmx-request",addedClass:"htmx-added",settlingClass:"htmx-settling",swappingClass:"htmx-swapping",allowEval:!0,allowScriptTags:!0,inlineScriptNonce:"",attributesToSettle:["class","style","width","height"],withCredentials:!1,timeout:0,wsReconnectDelay:"full-jitter",wsBinaryType:"blob",disableSelector:"[hx-disable], [data-hx-disable]",useTemplateFragments:!1,scrollBehavior:"smooth",defaultFocusScroll:!1,getCacheBusterParam:!1,globalViewTransitions:!1,methodsThatUseUrlParams:["get"]},parseInterval:d,_:e,createEventSource:function(e){return new EventSource(e,{withCredentials:!0})},createWebSocket:function(e){var t=new WebSocket(e,[]);return t.binaryType=Q.config.wsBinaryType,t},version:"1.9.10"},r={addTriggerHandler:Lt,bodyContains:oe,canAccessLocalStorage:D,findThisElement:xe,filterValues:Qt,hasAttribute:s,getAttributeValue:te,getClosestAttributeValue:re,getClosestMatch:x,getExpressionVars:Hr,getHeaders:Yt,getInputValues:Zt,getInternalData:ee,getSwapSpecification:Tr,getTriggerSpecs:jt,getTarget:be,makeFragment:I,mergeObjects:ae,makeSettleInfo:T,oobSwap:Ce,querySelectorExt:fe,selectAndSwap:Or,settleImmediately:Wt,shouldCancel:At,triggerEvent:ie,triggerErrorEvent:ne,withExtensions:Sr};function d(e){if(void 0!==e)return"ms"==e.slice(-2)?parseFloat(e.slice(0,-2))||void 0:"s"==e.slice(-1)?1e3*parseFloat(e.slice(0,-1))||void 0:"m"==e.slice(-1)?6e4*parseFloat(e.slice(0,-1))||void 0:parseFloat(e)||void 0}function f(e,t){return e.getAttribute&&e.getAttribute(t)}function s(e,t){return e.hasAttribute&&(e.hasAttribute(t)||e.hasAttribute("data-"+t))}function te(e,t){return f(e,t)||f(e,"data-"+t)}function u(e){return e.parentElement}function re(e,t){var r=null;for(;r=e||null,(e=u(e))&&"findThisElement"!==t;){if(s(e,t))return r?te(e,t):te(e,t)}}function x(e,t){for(;e&&!t(e);)e=u(e);return e||null}function p(e,t,r){var n=te(t,r),o=te(t,"hx-disinherit");if(e!==t&&o&&("*"===o||o.split(" ").indexOf(r)>=0))return"unset";return n}function re(t,r){var n=null;return x(t,function(e){return!!(n=p(t,e,r))}),n!=="unset"?n:null}function m(e,t){var r=e.matches||e.matchesSelector||e.msMatchesSelector||e.mozMatchesSelector||e.webkitMatchesSelector||e.oMatchesSelector;return!!r&&r.call(e,t)}function h(e){var t=/<([a-z][^\/\0>\x20\t\r\n\f]*)/i.exec(e);return t?t[1].toLowerCase():""}function v(e,t){for(var r=new DOMParser,n=r.parseFromString(e,"text/html"),o=n.body;t>0;)t--,o=o.firstChild;return null==o&&(o=Y().createDocumentFragment()),o}function I(e,t){if(t){var r,n=["thead","tbody","tfoot","colgroup","caption"].indexOf(t)>-1?"table":t,o=v("<"+n+">"+e+"</"+n+">",0);return o.querySelector(n).childNodes}if(Q.config.useTemplateFragments){if((r=Y().createElement("template")).innerHTML=e,r.content)return r.content.childNodes}return v(e,0).childNodes}function ae(e,t){for(var r in t)t.hasOwnProperty(r)&&(e[r]=t[r]);return e}function y(e){try{return JSON.parse(e)}catch(e){return Ar(e),null}}function b(e){return e.indexOf("-")!==-1}function w(e){var t=re(e,"hx-ext"),r=[];return t&&q(t.split(","),function(e){e=e.replace(/ /g,""),e.slice(0,7)!="ignore:"&&r.push(e)}),r}function Sr(e,t){if("undefined"!=typeof e)if(Array.isArray(e))q(e,function(e){Sr(e,t)});else{var r=w(e);q(r,function(e){var r=Er[e];r&&t(r)})}}function Ar(e){console&&console.error&&console.error(e)}function S(e,t){return"undefined"!=typeof e?e:t}function A(e){var t=Q.config.attributesToSettle;for(var r=0;r<t.length;r++)if(e===t[r])return!0;return!1}function E(e,t){q(e.attributes,function(r){!t.hasAttribute(r.name)&&A(r.name)&&e.removeAttribute(r.name)}),q(t.attributes,function(r){A(r.name)&&e.setAttribute(r.name,r.value)})}function C(e,t){return t?e.querySelector(t):C(Y().body,e)}function R(e,t){return t?e.querySelectorAll(t):R(Y().body,e)}function O(e,t){e=x(e,function(e){return null!=te(e,t)})}function Y(){return document}function q(e,t){if(e)for(var r=0;r<e.length;r++)t(e[r])}function L(e){return e.getRootNode&&e.getRootNode() instanceof ShadowRoot?Y().body.contains(e.getRootNode().host):Y().body.contains(e)}function oe(e){return L(e)}function N(e){return e.trim().split(/\s+/)}function H(e,t){for(var r in t)t.hasOwnProperty(r)&&(e[r]=t[r]);return e}function P(e){return[].filter.call(Y().querySelectorAll("[id]"),function(t){return te(t,"id")===e})[0]}function M(e,t){return t||"outerHTML"}function D(){var e="htmx:localStorageTest";try{return localStorage.setItem(e,e),localStorage.removeItem(e),!0}catch(e){return!1}}function F(e){var t=e.length;for(var r=0;r<t;r++){var n=e[t-r-1];n.parentElement?n.parentElement.removeChild(n):null}}function X(e){return e.replace(/[\r\n\t ]+/g," ").trim()}function ee(e){var t=e.htmx_internal;return t||(t=e.htmx_internal={}),t}function T(e){var t={elt:e};return Sr(e,function(e){t=ae(t,e.getSelectors?e.getSelectors():{})}),t}function $(e){var t=ee(e);return t.timeout||(t.timeout=setTimeout(function(){t.timeout=null,ie(e,"htmx:timeout",{})},Q.config.timeout))}function z(){Q.logger=function(e,t,r){console&&console.log(t,e,r)}}function K(){Q.logger=null}function C(e,t){return t?e.querySelector(t):C(Y().body,e)}function C(e){return C(Y().body,e)}function g(e,t){return(t=x(e,function(e){return m(e,t)}))||null}function W(){return Y().body}function B(e,t){e=fe(e),t?setTimeout(function(){B(e),e=null},d(t)):e.parentElement&&e.parentElement.removeChild(e)}function j(e,t,r){e=fe(e),r?setTimeout(function(){j(e,t),e=null},d(r)):e.classList&&e.classList.add(t)}function V(e,t,r){e=fe(e),r?setTimeout(function(){V(e,t),e=null},d(r)):e.classList&&e.classList.remove(t)}function U(e,t){e=fe(e),e.classList.toggle(t)}function _(e,t){e=fe(e),q(e.parentElement.children,function(e){V(e,t)}),j(e,t)}function g(e,t){return m(e=fe(e),t)?e:g(u(e),t)}function J(e,t,r){return Object.prototype.toString.call(e)==="[object "+t+"]"?e:{"string":function(){return String(e)},"int":function(){return parseInt(e)},"float":function(){return parseFloat(e)}}[t?t.toLowerCase():null]?{"string":function(){return String(e)},"int":function(){return parseInt(e)},"float":function(){return parseFloat(e)}}[t.toLowerCase()](e):r}function G(e,t){for(var r=0;r<e.length;r++)if(e[r]===t)return e.splice(r,1)}function Z(e,t,r){if(r){for(var n=0;n<e.length;n++){var o=e[n].match(t);if(o){return r(o[1],o[2])}}}return null}var Er={};function Cr(e,t){t.init&&t.init(r),Er[e]=ae(Er[e]||{},t)}function Rr(e){delete Er[e]}function Or(e,t,r,n,o){var i,a,s=S(n.select,n.swapSpec.select),u=[];if(s){q(C(t).querySelectorAll(s),function(e){e&&u.push(e)}),i=u}else if(i=[t],"outerHTML"!==r&&"none"!==r){for(;null!=(a=e.firstChild);)u.push(a),a.remove();i=u}Sr(n.elt,function(e){i=e.transformResponse?e.transformResponse(i,null,n.elt):i}),s&&"outerHTML"!==n.swapSpec.swapStyle&&(i=i[0]?i[0].children:i);var c,l=e;for(s&&(e.innerHTML="",l=e,c=n.swapSpec.swapStyle),c=c||r,Rt(l,i,c,n,o);(a=e.firstChild)!==null;)e.removeChild(a);return i}function Ce(e,t,r,n,o){var i=re(e,"hx-select-oob");if(i)for(var a=i.split(","),s=0;s<a.length;s++){var u=a[s].split(":",2),c=u[0].trim();if(0!==c.indexOf("#")&&(c="#"+c),c!==""){var l=C(c);if(l){var f=u[1]||"true",d="true"===f?re(l,"hx-swap")||Q.config.defaultSwapStyle:f;n||(n=T(t)),Rt(l,e.cloneNode(!0).querySelector(c),d,n,o)}}}q(R(e,"[hx-swap-oob], [data-hx-swap-oob]"),function(e){var t=te(e,"hx-swap-oob");if("true"===t)t=re(e,"hx-swap")||Q.config.defaultSwapStyle;else if(t.indexOf(":")>0){o=t.split(":"),t=o[0];var r=o[1];e.id=r}else e.id||((t=t||re(e,"hx-swap")||Q.config.defaultSwapStyle)==="true"&&(t=re(e,"hx-swap")||Q.config.defaultSwapStyle));var i=P(e.id);i&&(n||(n=T(i)),Or(i,e.cloneNode(!0),t,n,o));e.remove()})}function ne(e,t,r){ie(e,t,ae({error:t},r))}function ie(e,t,r,n){var o;return o=r?r:{},o.elt=e,oe(e)?n?e.dispatchEvent(new CustomEvent(t,{bubbles:!0,cancelable:!0,detail:o})):ie(e,t,o,!0):(o.target=e,o=ae(o,{bubbles:!0,cancelable:!0}),Y().dispatchEvent(new CustomEvent(t,{detail:o})),!o.defaultPrevented)}function le(e,t,r){var n=fe(e);return"htmx:"+t===r||"htmx-"+t===r?void n.addEventListener(t.slice(5),r):void n.addEventListener(t,r)}function ue(e,t,r){var n=fe(e);return void n.removeEventListener(t,r)}var ce=Y().createElement("output");function fe(e,t){return"string"==typeof e?C(t||Y().body,e):e}function de(e,t,r){return e.call(t,r)}function xe(e,t){return x(e,function(e){return te(e,"hx-target")!==null})||Y().body}function pe(e){return 0===e.indexOf("#")&&e.indexOf(" ")===-1&&e.indexOf(".")===e.lastIndexOf(".")?P(e.substring(1)):null}function be(e,t){var r=re(e,t);if(r){if("this"===r)return xe(e);if(r.indexOf("closest ")===0)return g(e,r.substr(8));if(r.indexOf("find ")===0)return C(e,r.substr(5));if(r.indexOf("next ")===0){var n=Y().querySelectorAll(r.substr(5));return Z(n,/(.+)/,function(t){return(1,e.compareDocumentPosition(C(t)))&Node.DOCUMENT_POSITION_FOLLOWING?C(t):null})}if(r.indexOf("previous ")===0){var n=Y().querySelectorAll(r.substr(9));return Z(n,/(.+)/,function(t){return(1,e.compareDocumentPosition(C(t)))&Node.DOCUMENT_POSITION_PRECEDING?C(t):null})}return pe(r)||C(Y().body,r)}}function me(e){var t=re(e,"hx-target");return t?be(e,t):xe(e)}function ye(e,t,r){var n=re(t,r);return n?n.indexOf("this")===0?xe(t):(be(t,n)||e):e}function ve(e){return S(re(e,"hx-sync"),"drop")}function Yt(e,t,r){var n={};return n["HX-Request"]="true",n["HX-Trigger"]=te(e,"id"),n["HX-Trigger-Name"]=te(e,"name"),n["HX-Target"]=te(t,"id"),n["HX-Current-URL"]=Y().location.href,r&&(n["Content-Type"]="application/x-www-form-urlencoded"),Q.config.getCacheBusterParam&&(n["HX-Cache-Buster"]="true"),Sr(e,function(e){n=ae(n,e.getHeaders?e.getHeaders():{})}),n}function Qt(e,t,r){var n={},o=new FormData,i=new URLSearchParams;function a(e,t){if(void 0!==t&&"undefined"!=typeof t){if(e in n){var r=n[e];Array.isArray(r)?r.push(t):n[e]=[r,t]}else n[e]=t;o.append(e,t),i.append(e,t)}}if(e)for(var s=0;s<e.length;s++){var u=e[s];if(!u.disabled&&""!==u.name){var c=u.name,l=u.value;if("file"===u.type)for(var f=0;f<u.files.length;f++)a(c,u.files[f]);else if("checkbox"===u.type){if(u.checked){var d=te(u,"value");a(c,d||"on")}}else"radio"===u.type?u.checked&&a(c,l):a(c,"SELECT"===u.tagName&&u.multiple?F([].filter.call(u.options,function(e){return e.selected}).map(function(e){return e.value})):l)}}return t&&!["get","delete"].includes(r.toLowerCase())&&("object"==typeof t?ae(n,t):n[t]=""),{errors:[],values:n,formData:o,urlParams:i}}function Zt(e,t){return Qt(R(e,"input, textarea, select, [contenteditable]"),t,M(e))}function Kt(e){Wt(e),ie(e,"htmx:load",{elt:e})}function Wt(e){var t=T(e);q(R(e,"[hx-get], [data-hx-get], [hx-post], [data-hx-post], [hx-put], [data-hx-put], [hx-delete], [data-hx-delete], [hx-patch], [data-hx-patch]"),function(e){Dt(e,t)})}function t(e){Q.logger=function(t,r,n){e(r,t,n)},Wt(Y().body)}function jt(e,t){var r=te(e,t),n=[];if(r)for(var o=r.split(","),i=0;i<o.length;i++){var a=o[i].trim();if(a.indexOf("[")===0){var s=a.indexOf("]");if(s>0){var u=a.substring(1,s).split(" "),c=u[0];if(c){var l=a.substring(s+1).trim(),f=Ut(l);n.push({trigger:c,sseEvent:u[1],eventFilter:null,pollInterval:f&&f.pollInterval,changed:f&&f.changed})}}}else{var l=a,f=Ut(l);n.push({trigger:f.trigger,sseEvent:f.sseEvent,eventFilter:f.eventFilter,pollInterval:f.pollInterval,changed:f.changed})}}return n.length>0?n:null}function Ut(e){for(var t={},r=e.split(" "),n=0;n<r.length;n++){var o=r[n];if(o)if(o.indexOf("sse:")===0)t.sseEvent=o.substring(4),t.trigger="sse";else if("changed"===o)t.changed=!0;else if(o.indexOf("every")===0){var i=o.split(":")[1];t.pollInterval=d(i),t.trigger="every"}else t.trigger=o}return t.trigger||(t.trigger="click"),t}function Lt(e,t,r){return void Sr(e,function(e){e.triggerHandler&&e.triggerHandler(e,t,r)})}function At(e,t,r){return r&&r.some(function(e){return e.trigger===t})?ie(e,"htmx:cancel",{}):!0}function _t(e,t){var r=te(e,"hx-encoding");return r||(t?"multipart/form-data":"application/x-www-form-urlencoded")}function Bt(e,t,r,n){var o=ee(e);if(t.length>0){for(var i=0;i<t.length;i++){var a=t[i];if(a.elt===e||x(a.elt,function(t){return t===e}))return}t.push({elt:e,xhr:r,onLoad:n}),o.queuedXhrs=t}else t.push({elt:e,xhr:r,onLoad:n}),o.queuedXhrs=t}function Gt(e){var t=ee(e);if(t.queuedXhrs){for(var r=t.queuedXhrs.shift();r;){if(r.xhr.readyState===0||r.xhr.readyState===4){r.onLoad(),ie(e,"htmx:afterProcess",{})}else{t.queuedXhrs.unshift(r);break}r=t.queuedXhrs.shift()}t.queuedXhrs.length===0&&delete t.queuedXhrs}}function Vt(e){var t=new XMLHttpRequest;return Sr(e,function(e){e.onInit&&e.onInit(t)}),t}function Dt(e){var t=re(e,"hx-swap");if(!t)return Q.config.defaultSwapStyle;var r={swapStyle:Q.config.defaultSwapStyle,swapDelay:Q.config.defaultSwapDelay,settleDelay:Q.config.defaultSettleDelay,ignoreTitle:!1,scroll:null,scrollTarget:null,show:null,showTarget:null,focusScroll:Q.config.defaultFocusScroll,select:null};for(var n=t.split(" "),o=0;o<n.length;o++){var i=n[o];if(i.indexOf("swap:")===0)r.swapDelay=d(i.substring(5));else if(i.indexOf("settle:")===0)r.settleDelay=d(i.substring(7));else if(i.indexOf("ignoreTitle")===0)r.ignoreTitle=!0;else if(i.indexOf("scroll:")===0){var a=i.substring(7);a.indexOf("#")===0?(r.scroll="top",r.scrollTarget=a.substring(1)):"top"===a||"bottom"===a?r.scroll=a:(r.scroll="top",r.scrollTarget=a)}else if(i.indexOf("show:")===0){var a=i.substring(5);a.indexOf("#")===0?(r.show="top",r.showTarget=a.substring(1)):"top"===a||"bottom"===a?r.show=a:(r.show="top",r.showTarget=a)}else if(i.indexOf("focus-scroll:")===0){var s=i.substring(13);"true"===s?r.focusScroll=!0:"false"===s&&(r.focusScroll=!1)}else r.swapStyle=i}return r}function Tr(e){return Dt(e)}function Rt(e,t,r,n,o){switch(r){case"none":return;case"outerHTML":e.parentElement.replaceChild(t.cloneNode(!0),e);break;case"afterbegin":e.insertBefore(t.cloneNode(!0),e.firstChild);break;case"beforebegin":e.parentElement.insertBefore(t.cloneNode(!0),e);break;case"beforeend":e.appendChild(t.cloneNode(!0));break;case"afterend":e.parentElement.insertBefore(t.cloneNode(!0),e.nextSibling);break;case"delete":e.parentElement&&e.parentElement.removeChild(e);break;default:e.innerHTML="",e.appendChild(t.cloneNode(!0))}}function Hr(e){return{}}function Mr(e,t,r){var n="string"==typeof e?{url:e}:e;return n.headers=n.headers||{},n.target=t||Y().body,r&&(n.handler=r),Ir(n.target,"hx-"+n.verb||"get",n.url,n)}function Ir(e,t,r,n){if(n=n||{},!1===ie(e,"htmx:confirm",{target:me(e)}))return;var o,i,a=n.verb||M(e,t),s=n.handler||function(e){var t=e.detail;Rr(t.target,t.content,t.swapSpec,t.settleInfo,t.select)};i=a==="get"?"get":"post",o=Vt(e),o.open(i.toUpperCase(),r,!0),o.overrideMimeType("text/html"),n.headers&&ae(o,n.headers);var u=Yt(e,me(e),i!=="get"),c=Zt(e,a),l=_t(e,c.formData&&c.formData.entries().next().value);u["Content-Type"]=l;var f=Dt(e);o.onload=function(){if(o.status>=200&&o.status<300){var t=o.response;ie(e,"htmx:beforeOnLoad",{xhr:o}),s({detail:{target:me(e),content:I(t),swapSpec:f,settleInfo:T(me(e)),xhr:o,select:n.select}}),ie(e,"htmx:afterOnLoad",{xhr:o}),Gt(e)}else ne(e,"htmx:responseError",{xhr:o})};o.onerror=function(){ne(e,"htmx:sendError",{xhr:o})};var d=c.urlParams.toString();if(i==="get"&&d){r+=(r.indexOf("?")>=0?"&":"?")+d,o.send()}else o.send(c.formData);ie(e,"htmx:xhr:loadstart",{xhr:o})}return Q}();
     )HTMX";
     }
 
+    // Without the line break and indentation around the literal
+    inline std::string_view htmx_script_compact_view() {
+        std::string_view script = htmx_script_view();
+        script.remove_prefix(script.find_first_not_of(" \n"));
+        script.remove_suffix(script.size() - 1 - script.find_last_not_of(" \n"));
+        return script;
+    }
+
+    inline std::string get_htmx_script() {
+        return std::string(htmx_script_view());
+    }
+
     // HTMX SSE Extension 2.2.1 - https://htmx.org/extensions/sse/
     // MIT License
-    inline std::string get_htmx_sse_extension() {
+    inline std::string_view htmx_sse_extension_view() {
         return R"SSE(
 (function(){
     var defined = function(value) { return typeof value !== "undefined"; };
@@ -129,4 +143,61 @@ namespace zero_js
         )SSE";
     }
 
+    namespace htmx_detail
+    {
+        inline bool is_word_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_' || c == '$';
+        }
+
+        // Drops the comments and the whitespace between tokens, keeping a
+        // space only where two tokens would otherwise run together (words,
+        // or "+ +" and "- -"). Strings are copied as they are. Enough for
+        // scripts written with explicit semicolons and without regular
+        // expression literals, like the bundled extension.
+        inline std::string strip_script(std::string_view script) {
+            std::string out;
+            out.reserve(script.size());
+            bool gap = false;
+            for (size_t i = 0; i < script.size(); ++i) {
+                char c = script[i];
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                    gap = true;
+                    continue;
+                }
+                if (c == '/' && i + 1 < script.size() && (script[i + 1] == '/' || script[i + 1] == '*')) {
+                    size_t end = script[i + 1] == '/' ? script.find('\n', i) : script.find("*/", i + 2);
+                    i = end == std::string_view::npos ? script.size() : (script[i + 1] == '/' ? end : end + 1);
+                    gap = true;
+                    continue;
+                }
+                if (gap && !out.empty()) {
+                    char last = out.back();
+                    if ((is_word_char(last) && is_word_char(c)) || ((c == '+' || c == '-') && last == c)) out += ' ';
+                }
+                gap = false;
+                out += c;
+                if (c == '"' || c == '\'' || c == '`') {
+                    for (++i; i < script.size() && script[i] != c; ++i) {
+                        if (script[i] == '\\' && i + 1 < script.size()) out += script[i++];
+                        out += script[i];
+                    }
+                    if (i < script.size()) out += c;
+                }
+            }
+            return out;
+        }
+    }
+
+    // The extension above with its whitespace removed, for compact pages;
+    // stripped once per process
+    inline std::string_view htmx_sse_extension_compact_view() {
+        static const std::string script = htmx_detail::strip_script(htmx_sse_extension_view());
+        return script;
+    }
+
+    inline std::string get_htmx_sse_extension() {
+        return std::string(htmx_sse_extension_view());
+    }
+
 }
\ No newline at end of file
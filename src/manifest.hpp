@@ -0,0 +1,94 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include "assets.hpp"
+#include "output.hpp"
+
+namespace zero_js
+{
+
+// ============================================================================
+// Build Manifest
+// ============================================================================
+
+// Hash of each output file's content as of the last build, kept in a text
+// file ("<hash> <path>" per line). Writes that go through it skip files whose
+// new content hashes the same, so unchanged files keep their mtime and
+// rsync or a CDN has nothing to re-transfer. Thread-safe.
+class BuildManifest {
+public:
+    BuildManifest() = default;
+
+    // Loads the manifest at path if there is one; save() writes it back
+    explicit BuildManifest(std::string path) : path_(std::move(path)) { load(); }
+
+    BuildManifest(const BuildManifest&) = delete;
+    BuildManifest& operator=(const BuildManifest&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    // A missing file is an empty manifest; malformed lines are skipped
+    void load() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hashes_.clear();
+        std::ifstream in(path_);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t space = line.find(' ');
+            if (space != 16 || space + 1 >= line.size()) continue;
+            uint64_t hash = 0;
+            auto [end, ec] = std::from_chars(line.data(), line.data() + space, hash, 16);
+            if (ec != std::errc() || end != line.data() + space) continue;
+            hashes_[line.substr(space + 1)] = hash;
+        }
+    }
+
+    // Written atomically, sorted by path
+    WriteResult save(SyncPolicy policy = SyncPolicy::None) const {
+        std::string text;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [file, hash] : hashes_) text.append(hash_hex(hash)).append(" ").append(file).append("\n");
+        }
+        return write_file_atomic(path_, std::string_view(text), policy);
+    }
+
+    // True if file exists and was last recorded with this hash
+    bool matches(const std::string& file, uint64_t hash) const {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = hashes_.find(file);
+            if (it == hashes_.end() || it->second != hash) return false;
+        }
+        return ::access(file.c_str(), F_OK) == 0;
+    }
+
+    void record(const std::string& file, uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hashes_[file] = hash;
+    }
+
+    void forget(const std::string& file) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hashes_.erase(file);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hashes_.size();
+    }
+
+private:
+    std::string path_;
+    mutable std::mutex mutex_;
+    std::map<std::string, uint64_t> hashes_;
+};
+
+}
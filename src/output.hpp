@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace zero_js
+{
+
+// ============================================================================
+// File Output
+// ============================================================================
+
+// Outcome of writing a file: the errno of the first failure and the call
+// that failed, or success
+struct WriteResult {
+    int error = 0;
+    const char* step = "";
+    bool unchanged = false;   // content matched a BuildManifest; the file was left alone
+
+    explicit operator bool() const { return error == 0; }
+    std::string message() const {
+        if (error == 0) return "ok";
+        return std::string(step) + ": " + std::strerror(error);
+    }
+};
+
+// Files are written to a temporary name and renamed into place, so readers
+// see the old file or the new one, never a torn one, even if the process
+// dies. Syncing additionally makes the new content survive a power loss.
+enum class SyncPolicy {
+    None,      // leave flushing to the kernel (fastest)
+    EachFile   // fsync each file and its directory before returning
+};
+
+class SyncBatch;
+class BuildManifest;
+
+// Compressed copies written next to each file (<path>.gz, <path>.zst), for
+// static servers that send them as they are. Levels as in gzip (1-9) and
+// zstd (1-19); 0 leaves a format out. Each format needs the library built
+// in (see compress.hpp).
+struct Precompress {
+    int gzip = 0;
+    int zstd = 0;
+};
+
+// Everything about how a file is written besides its content
+struct WriteOptions {
+    SyncPolicy sync = SyncPolicy::None;
+    SyncBatch* batch = nullptr;           // sync through this batch instead
+    BuildManifest* manifest = nullptr;    // skip pages whose content is unchanged
+    Precompress precompress;
+    // Told a page's final result once it is in place or has failed: when
+    // the write returns, or with a batch, when the batch commits it
+    std::function<void(const WriteResult&)> committed;
+};
+
+// A file whose content is complete in a temporary next to it, waiting to be
+// renamed into place
+struct StagedFile {
+    int fd = -1;
+    std::string temp;
+    std::string path;
+};
+
+namespace output_detail
+{
+    inline WriteResult failure(const char* step, int error = errno) {
+        WriteResult result;
+        result.error = error;
+        result.step = step;
+        return result;
+    }
+
+    inline std::string parent_dir(const std::string& path) {
+        size_t slash = path.rfind('/');
+        if (slash == std::string::npos) return ".";
+        return slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    inline WriteResult sync_dir(const std::string& dir) {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return failure("open directory");
+        WriteResult result;
+        if (::fsync(fd) != 0) result = failure("fsync directory");
+        ::close(fd);
+        return result;
+    }
+
+    // Creates dir unless a directory of that name is already there
+    inline WriteResult make_dir(const std::string& dir) {
+        if (::mkdir(dir.c_str(), 0755) == 0) return {};
+        if (errno != EEXIST) return failure("mkdir");
+        struct stat st;
+        if (::stat(dir.c_str(), &st) != 0) return failure("stat");
+        return S_ISDIR(st.st_mode) ? WriteResult() : failure("mkdir", ENOTDIR);
+    }
+
+    // Returns errno, or 0 once every byte is written
+    inline int write_all(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return errno;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return 0;
+    }
+
+    // Creates a hidden temporary next to path (".<name>.<random>"), so the
+    // rename stays on one file system and directory listings skip it. It is
+    // opened with mode 0666 like any new file, so the kernel applies the
+    // umask (and a default ACL) as it would to the final file.
+    inline int open_temp(const std::string& path, std::string& temp) {
+        static constexpr char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        thread_local std::mt19937_64 random(std::random_device{}());
+        size_t slash = path.rfind('/');
+        size_t name = slash == std::string::npos ? 0 : slash + 1;
+        temp.reserve(path.size() + 8);
+        temp.assign(path, 0, name).append(".").append(path, name, std::string::npos).append(".XXXXXX");
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            uint64_t bits = random();
+            for (size_t i = temp.size() - 6; i < temp.size(); ++i, bits >>= 6) temp[i] = letters[bits % 62];
+            int fd = ::open(temp.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0666);
+            if (fd >= 0 || errno != EEXIST) return fd;
+        }
+        return -1;
+    }
+
+    // Hints the kernel to start writeback now, so a later fsync has less
+    // left to wait for
+    inline void start_writeback(int fd) {
+#if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+        ::sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#else
+        (void)fd;
+#endif
+    }
+
+    // Drops a staged file, leaving whatever is at its path alone
+    inline void discard(StagedFile& file) {
+        if (file.fd >= 0) ::close(file.fd);
+        if (!file.temp.empty()) ::unlink(file.temp.c_str());
+        file.fd = -1;
+        file.temp.clear();
+    }
+
+    // Writes the content of path to a temporary; fill(fd) writes it and
+    // returns errno, or 0
+    template<typename Fill>
+    WriteResult stage(const std::string& path, Fill&& fill, StagedFile& file) {
+        file.path = path;
+        file.fd = open_temp(path, file.temp);
+        if (file.fd < 0) {
+            file.temp.clear();
+            return failure("open temporary");
+        }
+        int error = fill(file.fd);
+        if (error != 0) {
+            discard(file);
+            return failure("write", error);
+        }
+        return {};
+    }
+
+    inline WriteResult stage(const std::string& path, std::string_view content, StagedFile& file) {
+        return stage(path, [content](int fd) {
+            return write_all(fd, content.data(), content.size());
+        }, file);
+    }
+
+    // Syncs the file as policy says, closes it and renames it into place
+    inline WriteResult publish(StagedFile& file, SyncPolicy policy) {
+        if (policy == SyncPolicy::EachFile && ::fsync(file.fd) != 0) {
+            WriteResult result = failure("fsync");
+            discard(file);
+            return result;
+        }
+        int closed = ::close(file.fd);
+        file.fd = -1;
+        if (closed != 0) {
+            WriteResult result = failure("close");
+            discard(file);
+            return result;
+        }
+        if (::rename(file.temp.c_str(), file.path.c_str()) != 0) {
+            WriteResult result = failure("rename");
+            discard(file);
+            return result;
+        }
+        file.temp.clear();
+        if (policy == SyncPolicy::EachFile) return sync_dir(parent_dir(file.path));
+        return {};
+    }
+}
+
+// Groups the fsyncs of many files: each added file has its writeback
+// started right away and is renamed into place at the next commit(), after
+// all of them have been synced; each directory is synced once per commit.
+// Much faster than SyncPolicy::EachFile for thousands of pages, at the cost
+// of files appearing in groups. Commits by itself every max_pending files
+// and on destruction; commits run one at a time, in the order files were
+// added. Thread-safe.
+class SyncBatch {
+public:
+    // Told a group's result once its files are in place or have failed
+    using Done = std::function<void(const WriteResult&)>;
+
+    explicit SyncBatch(size_t max_pending = 256) : max_pending_(max_pending ? max_pending : 1) {}
+    ~SyncBatch() { commit(); }
+
+    SyncBatch(const SyncBatch&) = delete;
+    SyncBatch& operator=(const SyncBatch&) = delete;
+
+    // Syncs and renames every file added so far. Files that fail are left
+    // out. Returns the first failure since the last call, including those
+    // of the commits made by add().
+    WriteResult commit() {
+        std::lock_guard<std::mutex> order(commit_mutex_);
+        WriteResult result = commit_pending();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!first_error_) result = first_error_;
+        first_error_ = {};
+        return result;
+    }
+
+    // Files added and not yet committed
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return files_;
+    }
+
+    // Takes the staged files as one group: at commit the first is renamed
+    // into place, then the rest (e.g. its precompressed copies). If the
+    // first cannot be, the rest are dropped with it. done gets the group's
+    // result from the thread that commits it; it must not add to the batch.
+    void add(std::vector<StagedFile> group, Done done = nullptr) {
+        for (const StagedFile& file : group) output_detail::start_writeback(file.fd);
+        bool full = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            files_ += group.size();
+            pending_.push_back({std::move(group), std::move(done), {}});
+            full = files_ >= max_pending_;
+        }
+        if (!full) return;
+        std::lock_guard<std::mutex> order(commit_mutex_);
+        WriteResult result = commit_pending();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (first_error_ && !result) first_error_ = result;
+    }
+
+    void add(StagedFile file, Done done = nullptr) {
+        std::vector<StagedFile> group;
+        group.push_back(std::move(file));
+        add(std::move(group), std::move(done));
+    }
+
+private:
+    struct Group {
+        std::vector<StagedFile> files;
+        Done done;
+        WriteResult result;
+    };
+
+    // Called with commit_mutex_ held, so batches commit in order
+    WriteResult commit_pending() {
+        std::vector<Group> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(pending_);
+            files_ = 0;
+        }
+        return commit(batch);
+    }
+
+    static WriteResult commit(std::vector<Group>& batch) {
+        for (Group& group : batch) {
+            for (StagedFile& file : group.files) {
+                if (group.result && ::fsync(file.fd) != 0) group.result = output_detail::failure("fsync");
+            }
+        }
+        std::vector<std::string> dirs;
+        for (Group& group : batch) {
+            bool dropped = !group.result;
+            for (StagedFile& file : group.files) {
+                if (dropped) {
+                    output_detail::discard(file);
+                    continue;
+                }
+                WriteResult published = output_detail::publish(file, SyncPolicy::None);
+                if (!published) {
+                    if (group.result) group.result = published;
+                    // Nothing follows a first file that is not in place
+                    dropped = &file == &group.files.front();
+                    continue;
+                }
+                std::string dir = output_detail::parent_dir(file.path);
+                if (std::find(dirs.begin(), dirs.end(), dir) == dirs.end()) dirs.push_back(std::move(dir));
+            }
+        }
+        std::vector<WriteResult> synced;
+        for (const std::string& dir : dirs) synced.push_back(output_detail::sync_dir(dir));
+
+        WriteResult first;
+        for (Group& group : batch) {
+            for (const StagedFile& file : group.files) {
+                if (!group.result) break;
+                size_t at = std::find(dirs.begin(), dirs.end(), output_detail::parent_dir(file.path)) - dirs.begin();
+                if (at < synced.size() && !synced[at]) group.result = synced[at];
+            }
+            if (first && !group.result) first = group.result;
+            if (group.done) group.done(group.result);
+        }
+        return first;
+    }
+
+    mutable std::mutex mutex_;
+    std::mutex commit_mutex_;
+    std::vector<Group> pending_;
+    size_t files_ = 0;
+    size_t max_pending_;
+    WriteResult first_error_;   // from commits made by add()
+};
+
+namespace output_detail
+{
+    // With a batch the staged file is handed over to it instead of being
+    // renamed here
+    template<typename Fill>
+    WriteResult write_file(const std::string& path, Fill&& fill, SyncPolicy policy, SyncBatch* batch) {
+        StagedFile file;
+        WriteResult staged = stage(path, std::forward<Fill>(fill), file);
+        if (!staged) return staged;
+        if (batch) {
+            batch->add(std::move(file));
+            return {};
+        }
+        return publish(file, policy);
+    }
+}
+
+// Replaces path atomically with whatever fill(fd) writes; fill returns errno,
+// or 0 on success
+template<typename Fill, typename = std::enable_if_t<std::is_invocable_r_v<int, Fill&, int>>>
+WriteResult write_file_atomic(const std::string& path, Fill&& fill, SyncPolicy policy = SyncPolicy::None) {
+    return output_detail::write_file(path, std::forward<Fill>(fill), policy, nullptr);
+}
+
+template<typename Fill, typename = std::enable_if_t<std::is_invocable_r_v<int, Fill&, int>>>
+WriteResult write_file_atomic(const std::string& path, Fill&& fill, SyncBatch& batch) {
+    return output_detail::write_file(path, std::forward<Fill>(fill), SyncPolicy::None, &batch);
+}
+
+// Uses the sync policy or batch of options
+template<typename Fill, typename = std::enable_if_t<std::is_invocable_r_v<int, Fill&, int>>>
+WriteResult write_file_atomic(const std::string& path, Fill&& fill, const WriteOptions& options) {
+    return output_detail::write_file(path, std::forward<Fill>(fill), options.sync, options.batch);
+}
+
+inline WriteResult write_file_atomic(const std::string& path, std::string_view content,
+                                     SyncPolicy policy = SyncPolicy::None) {
+    return write_file_atomic(path, [content](int fd) {
+        return output_detail::write_all(fd, content.data(), content.size());
+    }, policy);
+}
+
+inline WriteResult write_file_atomic(const std::string& path, std::string_view content, SyncBatch& batch) {
+    return write_file_atomic(path, [content](int fd) {
+        return output_detail::write_all(fd, content.data(), content.size());
+    }, batch);
+}
+
+inline WriteResult write_file_atomic(const std::string& path, std::string_view content, const WriteOptions& options) {
+    return write_file_atomic(path, [content](int fd) {
+        return output_detail::write_all(fd, content.data(), content.size());
+    }, options);
+}
+
+}
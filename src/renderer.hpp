@@ -1,61 +1,206 @@
 #pragma once
 
 #include <string>
-#include <sstream>
-#include <fstream>
-#include "styles.hpp"
+#include "sink.hpp"
+#include "output.hpp"
+#include "themes.hpp"
 #include "htmx.hpp"
 
 namespace zero_js
 {
+    // What goes into <head>. The stylesheet is either inlined (css) or linked
+    // (stylesheet_href). With defer_stylesheet both are used: css is inlined
+    // for the first paint and the linked sheet loads without blocking it.
+    // Views are referenced, not copied, by scatter-gather sinks, so they must
+    // outlive the sink's flush (cached_css() always does).
+    struct PageHead {
+    std::string_view title;
+    std::string_view css;
+    std::string_view stylesheet_href;
+    bool defer_stylesheet = false;
+    std::string_view font_css;     // @font-face rules, inlined ahead of the stylesheet
+    std::string_view data_theme;   // data-theme on <html>, for multi-theme sheets
+    bool include_htmx = true;
+    bool include_sse = false;
+    // Load htmx and its SSE extension from these URLs with defer instead of
+    // inlining them
+    std::string_view htmx_src;
+    std::string_view sse_src;
+    // No indentation or line breaks in the document shell, and the compact
+    // forms of the inlined scripts. The css is used as given.
+    bool compact = false;
+};
+
+    // The fixed text around the head's variable parts, written out or
+    // compact, so either layout costs the same to render
+    struct PageShell {
+    std::string_view open;             // up to the attributes of <html>
+    std::string_view head;             // through "<title>"
+    std::string_view title_close;
+    std::string_view style_open;
+    std::string_view style_close;
+    std::string_view link_open;
+    std::string_view link_close;
+    std::string_view preload_open;
+    std::string_view preload_close;    // and the <noscript> fallback up to its href
+    std::string_view noscript_close;
+    std::string_view script_open;
+    std::string_view script_close;
+    std::string_view script_src_open;
+    std::string_view script_src_close;
+    std::string_view body;             // "</head>" through "<body>"
+    std::string_view close;            // "</body>" through "</html>"
+};
+
+    inline constexpr PageShell pretty_shell = {
+    "<!DOCTYPE html>\n<html lang=\"en\"",
+    ">\n<head>\n    <meta charset=\"UTF-8\">\n"
+    "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n    <title>",
+    "</title>\n",
+    "    <style>\n",
+    "    </style>\n",
+    "    <link rel=\"stylesheet\" href=\"",
+    "\">\n",
+    "    <link rel=\"preload\" href=\"",
+    "\" as=\"style\" onload=\"this.onload=null;this.rel='stylesheet'\">\n"
+    "    <noscript><link rel=\"stylesheet\" href=\"",
+    "\"></noscript>\n",
+    "    <script>",
+    "    </script>\n",
+    "    <script src=\"",
+    "\" defer></script>\n",
+    "</head>\n<body>\n",
+    "</body>\n</html>\n",
+};
+
+    inline constexpr PageShell compact_shell = {
+    "<!DOCTYPE html><html lang=\"en\"",
+    "><head><meta charset=\"UTF-8\">"
+    "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\"><title>",
+    "</title>",
+    "<style>",
+    "</style>",
+    "<link rel=\"stylesheet\" href=\"",
+    "\">",
+    "<link rel=\"preload\" href=\"",
+    "\" as=\"style\" onload=\"this.onload=null;this.rel='stylesheet'\">"
+    "<noscript><link rel=\"stylesheet\" href=\"",
+    "\"></noscript>",
+    "<script>",
+    "</script>",
+    "<script src=\"",
+    "\" defer></script>",
+    "</head><body>",
+    "</body></html>",
+};
+
+    // Everything up to and including <body>
+    inline void render_page_open(Sink& html, const PageHead& head) {
+    const PageShell& shell = head.compact ? compact_shell : pretty_shell;
+    html << shell.open;
+    if (!head.data_theme.empty()) {
+        html << " data-theme=\"" << head.data_theme << "\"";
+    }
+    html << shell.head;
+    html.write_ref(head.title.data(), head.title.size());
+    html << shell.title_close;
+    if (!head.font_css.empty()) {
+        html << shell.style_open;
+        html.write_ref(head.font_css.data(), head.font_css.size());
+        html << shell.style_close;
+    }
+    if (!head.stylesheet_href.empty() && head.defer_stylesheet) {
+        html << shell.style_open;
+        html.write_ref(head.css.data(), head.css.size());
+        html << shell.style_close;
+        // Preloaded, then applied once it arrives; without scripts it is
+        // linked normally
+        html << shell.preload_open << head.stylesheet_href << shell.preload_close
+             << head.stylesheet_href << shell.noscript_close;
+    } else if (!head.stylesheet_href.empty()) {
+        html << shell.link_open << head.stylesheet_href << shell.link_close;
+    } else {
+        html << shell.style_open;
+        html.write_ref(head.css.data(), head.css.size());
+        html << shell.style_close;
+    }
+
+    if (head.include_htmx && !head.htmx_src.empty()) {
+        // Deferred scripts run in document order, so the extension still
+        // finds htmx
+        html << shell.script_src_open << head.htmx_src << shell.script_src_close;
+        if (head.include_sse) {
+            html << shell.script_src_open << head.sse_src << shell.script_src_close;
+        }
+    } else if (head.include_htmx) {
+        html << shell.script_open;
+        // Static blobs: referenced in place by scatter-gather sinks
+        const std::string_view htmx = head.compact ? htmx_script_compact_view() : htmx_script_view();
+        html.write_ref(htmx.data(), htmx.size());
+        html << shell.script_close;
+
+        if (head.include_sse) {
+            html << shell.script_open;
+            const std::string_view sse = head.compact ? htmx_sse_extension_compact_view() : htmx_sse_extension_view();
+            html.write_ref(sse.data(), sse.size());
+            html << shell.script_close;
+        }
+    }
+
+    html << shell.body;
+}
+
+    inline void render_page_open(
+    Sink& html,
+    const std::string& title,
+    std::string_view css,
+    bool include_htmx = true,
+    bool include_sse = false
+) {
+    PageHead head;
+    head.title = title;
+    head.css = css;
+    head.include_htmx = include_htmx;
+    head.include_sse = include_sse;
+    render_page_open(html, head);
+}
+
+    inline void render_page_close(Sink& html, bool compact = false) {
+    html << (compact ? compact_shell : pretty_shell).close;
+}
+
+    // compact drops the shell's whitespace and implies the minified stylesheet
     inline std::string render_page_html(
     const std::string& title,
     const std::string& body_content,
     bool include_htmx = true,
     ThemeMode mode = ThemeMode::Dark,
-    bool include_sse = false
+    bool include_sse = false,
+    bool minify_css = false,
+    bool compact = false
 ) {
-    Theme theme;
-    theme.mode = mode;
-
-    std::ostringstream html;
-
-    html << "<!DOCTYPE html>\n";
-    html << "<html lang=\"en\">\n";
-    html << "<head>\n";
-    html << "    <meta charset=\"UTF-8\">\n";
-    html << "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n";
-    html << "    <title>" << title << "</title>\n";
-    html << "    <style>\n";
-    html << generate_css(theme);
-    html << "    </style>\n";
-
-    if (include_htmx) {
-        html << R"(<script src="https://unpkg.com/htmx.org@1.9.10">\n)";
-        html << get_htmx_script();
-        html << "    </script>\n";
-
-        if (include_sse) {
-            html << R"(<script src="https://unpkg.com/htmx.org@1.9.10">\n)";
-            html << get_htmx_sse_extension();
-            html << "    </script>\n";
-        }
-    }
+    const std::string_view css = cached_css(mode, minify_css || compact);
 
-    html << "</head>\n";
-    html << "<body>\n";
+    std::string out;
+    out.reserve(css.size() + body_content.size() + 1024 +
+                (include_htmx ? htmx_script_view().size() : 0) +
+                (include_htmx && include_sse ? htmx_sse_extension_view().size() : 0));
+    StringSink html(out);
+    PageHead head;
+    head.title = title;
+    head.css = css;
+    head.include_htmx = include_htmx;
+    head.include_sse = include_sse;
+    head.compact = compact;
+    render_page_open(html, head);
     html << body_content;
-    html << "</body>\n";
-    html << "</html>\n";
-
-    return html.str();
+    render_page_close(html, compact);
+    return out;
 }
 
-inline void write_to_file(const std::string& path, const std::string& content) {
-    std::ofstream file(path);
-    if (file.is_open()) {
-        file << content;
-        file.close();
-    }
+// Replaces the file atomically (see write_file_atomic())
+inline WriteResult write_to_file(const std::string& path, const std::string& content,
+                                 SyncPolicy policy = SyncPolicy::None) {
+    return write_file_atomic(path, std::string_view(content), policy);
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace zero_js
+{
+
+// ============================================================================
+// Rendered Markup Scanning
+// ============================================================================
+
+// Calls fn(tag, name, value) for every attribute of every start tag in an
+// HTML fragment. Only real tags are looked at: text, comments and the
+// contents of <script>/<style> are skipped, so class="..." appearing in
+// prose does not count. Names are reported as written.
+template<typename Fn>
+void for_each_attribute(std::string_view html, Fn&& fn) {
+    auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; };
+    auto skip_past = [&html](size_t from, std::string_view end) {
+        size_t at = html.find(end, from);
+        return at == std::string_view::npos ? html.size() : at + end.size();
+    };
+
+    size_t i = 0;
+    while ((i = html.find('<', i)) != std::string_view::npos) {
+        if (html.compare(i, 4, "<!--") == 0) { i = skip_past(i + 4, "-->"); continue; }
+        ++i;
+        if (i >= html.size()) break;
+        char first = html[i];
+        if (first == '/' || first == '!' || first == '?') { i = skip_past(i, ">"); continue; }
+        if (!((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z'))) continue;
+
+        size_t tag_start = i;
+        while (i < html.size() && !is_space(html[i]) && html[i] != '>' && html[i] != '/') ++i;
+        std::string_view tag = html.substr(tag_start, i - tag_start);
+
+        while (i < html.size()) {
+            while (i < html.size() && (is_space(html[i]) || html[i] == '/')) ++i;
+            if (i >= html.size() || html[i] == '>') break;
+
+            size_t name_start = i;
+            while (i < html.size() && !is_space(html[i]) && html[i] != '=' && html[i] != '>' && html[i] != '/') ++i;
+            std::string_view name = html.substr(name_start, i - name_start);
+
+            std::string_view value;
+            while (i < html.size() && is_space(html[i])) ++i;
+            if (i < html.size() && html[i] == '=') {
+                ++i;
+                while (i < html.size() && is_space(html[i])) ++i;
+                if (i < html.size() && (html[i] == '"' || html[i] == '\'')) {
+                    char quote = html[i++];
+                    size_t end = html.find(quote, i);
+                    if (end == std::string_view::npos) end = html.size();
+                    value = html.substr(i, end - i);
+                    i = end + 1;
+                } else {
+                    size_t value_start = i;
+                    while (i < html.size() && !is_space(html[i]) && html[i] != '>') ++i;
+                    value = html.substr(value_start, i - value_start);
+                }
+            }
+            fn(tag, name, value);
+        }
+
+        if (tag == "script" || tag == "style") {
+            i = skip_past(i, tag == "script" ? std::string_view("</script") : std::string_view("</style"));
+        }
+    }
+}
+
+// Calls fn(text) for every run of text between tags, as written (character
+// references are not decoded). Comments and the contents of <script>/<style>
+// are skipped.
+template<typename Fn>
+void for_each_text(std::string_view html, Fn&& fn) {
+    size_t i = 0;
+    while (i < html.size()) {
+        size_t open = html.find('<', i);
+        if (open == std::string_view::npos) open = html.size();
+        if (open > i) fn(html.substr(i, open - i));
+        if (open == html.size()) break;
+
+        size_t close;
+        if (html.compare(open, 4, "<!--") == 0) {
+            close = html.find("-->", open + 4);
+            i = close == std::string_view::npos ? html.size() : close + 3;
+            continue;
+        }
+        // The end of the tag, stepping over quoted attribute values
+        char quote = 0;
+        for (close = open + 1; close < html.size(); ++close) {
+            char c = html[close];
+            if (quote) { if (c == quote) quote = 0; }
+            else if (c == '"' || c == '\'') quote = c;
+            else if (c == '>') break;
+        }
+        if (close >= html.size()) break;
+        i = close + 1;
+        std::string_view tag = html.substr(open + 1, close - open - 1);
+        for (std::string_view raw : {std::string_view("script"), std::string_view("style")}) {
+            if (tag.compare(0, raw.size(), raw) == 0 &&
+                (tag.size() == raw.size() || tag[raw.size()] == ' ' || tag[raw.size()] == '\t' || tag[raw.size()] == '\n')) {
+                size_t end = html.find(raw == "script" ? "</script" : "</style", i);
+                i = end == std::string_view::npos ? html.size() : end;
+            }
+        }
+    }
+}
+
+// Adds each class in a space-separated class list. The views point into list.
+inline void add_class_list(std::string_view list, std::unordered_set<std::string_view>& classes) {
+    auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; };
+    size_t i = 0;
+    while (i < list.size()) {
+        while (i < list.size() && is_space(list[i])) ++i;
+        size_t start = i;
+        while (i < list.size() && !is_space(list[i])) ++i;
+        if (i > start) classes.insert(list.substr(start, i - start));
+    }
+}
+
+// Every class named in a class="..." attribute. The views point into html.
+inline void collect_classes(std::string_view html, std::unordered_set<std::string_view>& classes) {
+    for_each_attribute(html, [&classes](std::string_view, std::string_view name, std::string_view value) {
+        if (name == "class") add_class_list(value, classes);
+    });
+}
+
+}
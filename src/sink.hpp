@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <streambuf>
+#include <charconv>
+#include <type_traits>
+#include <memory>
+#include <vector>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <sys/uio.h>
+
+namespace zero_js
+{
+
+// ============================================================================
+// Output Sinks
+// ============================================================================
+
+// Components render by appending into a Sink. The page is written in a single
+// pass, straight into whatever the caller owns (a string, a stream, a file
+// descriptor or a socket), with no intermediate string per node.
+//
+// write() bytes may be gone as soon as the call returns. write_ref() bytes
+// stay valid until the sink is flushed: string literals, and strings owned by
+// the tree being rendered. Sinks that copy anyway treat both the same.
+class Sink {
+public:
+    virtual ~Sink() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void write_ref(const char* data, size_t size) { write(data, size); }
+
+    // Literals and component-owned strings are passed by reference; views,
+    // pointers and temporaries are copied
+    template<size_t N>
+    Sink& operator<<(const char (&s)[N]) { write_ref(s, N - 1); return *this; }
+    Sink& operator<<(const std::string& s) { write_ref(s.data(), s.size()); return *this; }
+    Sink& operator<<(std::string&& s) { write(s.data(), s.size()); return *this; }
+    Sink& operator<<(std::string_view s) { write(s.data(), s.size()); return *this; }
+    // A template so that arrays still pick the literal overload above
+    template<typename T, typename = std::enable_if_t<std::is_same<T, const char*>::value>>
+    Sink& operator<<(const T& s) { return *this << std::string_view(s); }
+    Sink& operator<<(char c) { write(&c, 1); return *this; }
+    Sink& operator<<(int value) {
+        char buf[16];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        write(buf, result.ptr - buf);
+        return *this;
+    }
+};
+
+// Appends into a std::string, either its own or one owned by the caller
+class StringSink : public Sink {
+public:
+    StringSink() : out_(own_) {}
+    explicit StringSink(std::string& target) : out_(target) {}
+
+    void write(const char* data, size_t size) override { out_.append(data, size); }
+
+    std::string& str() { return out_; }
+
+private:
+    std::string own_;
+    std::string& out_;
+};
+
+// Discards the bytes and only counts them. Rendering into it is the measure
+// pass that tells a caller the exact output size up front.
+class CountingSink : public Sink {
+public:
+    void write(const char*, size_t size) override { size_ += size; }
+
+    size_t size() const { return size_; }
+
+private:
+    size_t size_ = 0;
+};
+
+// Forwards to any std::ostream (std::cout, std::ofstream, ...)
+class StreamSink : public Sink {
+public:
+    explicit StreamSink(std::ostream& os) : os_(os) {}
+
+    void write(const char* data, size_t size) override { os_.write(data, size); }
+
+private:
+    std::ostream& os_;
+};
+
+// Buffered writer on a raw file descriptor, so a page can go straight to a
+// file or a socket. The descriptor is not owned; the buffer is flushed on
+// destruction. The first write error is kept and later writes are dropped.
+class FdSink : public Sink {
+public:
+    explicit FdSink(int fd, size_t buffer_size = 64 * 1024) : fd_(fd), capacity_(buffer_size) {
+        buffer_.reserve(capacity_);
+    }
+    ~FdSink() override { flush(); }
+
+    FdSink(const FdSink&) = delete;
+    FdSink& operator=(const FdSink&) = delete;
+
+    void write(const char* data, size_t size) override {
+        if (buffer_.size() + size > capacity_) {
+            flush();
+            if (size >= capacity_) {
+                write_all(data, size);
+                return;
+            }
+        }
+        buffer_.append(data, size);
+    }
+
+    bool flush() {
+        if (!buffer_.empty()) {
+            write_all(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+        return ok();
+    }
+
+    bool ok() const { return error_ == 0; }
+    int error() const { return error_; }
+
+private:
+    void write_all(const char* data, size_t size) {
+        while (size > 0 && error_ == 0) {
+            ssize_t n = ::write(fd_, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error_ = errno;
+                return;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    int fd_;
+    size_t capacity_;
+    std::string buffer_;
+    int error_ = 0;
+};
+
+// Collects the output as a list of segments for writev(): literals and
+// component strings are referenced in place, everything else is copied into
+// small scratch chunks. References shorter than an iovec are copied too.
+// The tree being rendered must outlive flush().
+class SegmentSink : public Sink {
+public:
+    explicit SegmentSink(size_t chunk_size = 4096) : chunk_size_(chunk_size) {}
+
+    SegmentSink(const SegmentSink&) = delete;
+    SegmentSink& operator=(const SegmentSink&) = delete;
+
+    void write(const char* data, size_t size) override {
+        if (size == 0) return;
+        if (cursor_ + size > chunk_end_) {
+            if (size > chunk_size_ / 4) {
+                // Large copies get a chunk of their own
+                chunks_.emplace_back(new char[size]);
+                std::char_traits<char>::copy(chunks_.back().get(), data, size);
+                append(chunks_.back().get(), size);
+                return;
+            }
+            chunks_.emplace_back(new char[chunk_size_]);
+            cursor_ = chunks_.back().get();
+            chunk_end_ = cursor_ + chunk_size_;
+        }
+        std::char_traits<char>::copy(cursor_, data, size);
+        append(cursor_, size);
+        cursor_ += size;
+    }
+
+    void write_ref(const char* data, size_t size) override {
+        if (size < sizeof(iovec)) {
+            write(data, size);
+            return;
+        }
+        append(data, size);
+    }
+
+    const std::vector<iovec>& segments() const { return segments_; }
+    size_t size() const { return size_; }
+
+    void append_to(std::string& out) const {
+        out.reserve(out.size() + size_);
+        for (const iovec& v : segments_) out.append(static_cast<const char*>(v.iov_base), v.iov_len);
+    }
+
+    // Writes every segment to fd, at most IOV_MAX per call, resuming after
+    // short writes. The segments are consumed either way.
+    bool flush(int fd) {
+        size_t i = 0;
+        while (i < segments_.size() && error_ == 0) {
+            int count = static_cast<int>(std::min(segments_.size() - i, max_iov()));
+            ssize_t n = ::writev(fd, &segments_[i], count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error_ = errno;
+                break;
+            }
+            size_t done = static_cast<size_t>(n);
+            while (i < segments_.size() && done >= segments_[i].iov_len) {
+                done -= segments_[i].iov_len;
+                ++i;
+            }
+            if (done > 0) {
+                segments_[i].iov_base = static_cast<char*>(segments_[i].iov_base) + done;
+                segments_[i].iov_len -= done;
+            }
+        }
+        clear();
+        return ok();
+    }
+
+    void clear() {
+        segments_.clear();
+        chunks_.clear();
+        cursor_ = chunk_end_ = nullptr;
+        size_ = 0;
+    }
+
+    bool ok() const { return error_ == 0; }
+    int error() const { return error_; }
+
+private:
+    static size_t max_iov() {
+#ifdef IOV_MAX
+        return IOV_MAX;
+#else
+        return 1024;
+#endif
+    }
+
+    // Extends the previous segment when the bytes follow on from it
+    void append(const char* data, size_t size) {
+        size_ += size;
+        if (!segments_.empty()) {
+            iovec& last = segments_.back();
+            if (static_cast<const char*>(last.iov_base) + last.iov_len == data) {
+                last.iov_len += size;
+                return;
+            }
+        }
+        segments_.push_back(iovec{const_cast<char*>(data), size});
+    }
+
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* cursor_ = nullptr;
+    char* chunk_end_ = nullptr;
+    std::vector<iovec> segments_;
+    size_t size_ = 0;
+    int error_ = 0;
+};
+
+// Adapts a Sink to std::streambuf so code that relies on iostream number
+// formatting (the SVG charts) can still write straight into the sink
+class SinkStreamBuf : public std::streambuf {
+public:
+    explicit SinkStreamBuf(Sink& sink) : sink_(sink) { setp(buffer_, buffer_ + sizeof(buffer_)); }
+    ~SinkStreamBuf() override { sync(); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        sync();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (n <= epptr() - pptr()) {
+            traits_type::copy(pptr(), s, static_cast<size_t>(n));
+            pbump(static_cast<int>(n));
+            return n;
+        }
+        sync();
+        sink_.write(s, static_cast<size_t>(n));
+        return n;
+    }
+
+    int sync() override {
+        if (pptr() > pbase()) {
+            sink_.write(pbase(), static_cast<size_t>(pptr() - pbase()));
+            setp(buffer_, buffer_ + sizeof(buffer_));
+        }
+        return 0;
+    }
+
+private:
+    Sink& sink_;
+    char buffer_[256];
+};
+
+}
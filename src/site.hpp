@@ -0,0 +1,228 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "components.hpp"
+#include "assets.hpp"
+#include "fonts.hpp"
+#include "manifest.hpp"
+#include "output.hpp"
+#include "thread_pool.hpp"
+
+namespace zero_js
+{
+
+// ============================================================================
+// Multi-Page Site Builder
+// ============================================================================
+
+// How long one page took, and whether it was written
+struct PageTiming {
+    std::string path;
+    std::chrono::nanoseconds build{0};    // running its factory (both times), if it has one
+    std::chrono::nanoseconds write{0};    // rendering and writing the file
+    WriteResult result;
+};
+
+struct SiteReport {
+    std::vector<PageTiming> pages;        // in the order they were added
+    std::chrono::nanoseconds total{0};
+    WriteResult commit;                   // the first failure of the SyncBatch's commits, if batched
+    WriteResult manifest;                 // saving the manifest, if there is one
+
+    size_t failed() const {
+        size_t count = 0;
+        for (const PageTiming& page : pages) count += page.result ? 0 : 1;
+        return count;
+    }
+
+    // Pages left alone because the manifest had their content already
+    size_t unchanged() const {
+        size_t count = 0;
+        for (const PageTiming& page : pages) count += page.result.unchanged ? 1 : 0;
+        return count;
+    }
+
+    // The first failure in page order, then the commit and the manifest
+    WriteResult first_error() const {
+        for (const PageTiming& page : pages) {
+            if (!page.result) return page.result;
+        }
+        return commit ? manifest : commit;
+    }
+};
+
+// Renders and writes many pages at once, one task per page on a
+// work-stealing ThreadPool. Stylesheets, scripts and fonts that several
+// pages link are written once. Pages built by a factory exist only while
+// their task runs, so large sites need not hold every tree in memory;
+// factories must be safe to call from several threads. Self-hosted fonts
+// are subset once for the whole site, to the characters of all the pages
+// that use them, so they share one cacheable file per font; the factories
+// of those pages are called twice, once to collect the characters.
+//
+//     Site site;
+//     for (const Doc& doc : docs) {
+//         site.add("out/" + doc.slug + ".html", [&doc] { return doc_page(doc); });
+//     }
+//     SiteReport report = site.build();
+class Site {
+public:
+    explicit Site(ThreadPool& pool = default_thread_pool()) : pool_(&pool) {}
+
+    Site& add(const std::string& path, Page page) {
+        entries_.push_back({path, std::make_shared<const Page>(std::move(page)), nullptr});
+        return *this;
+    }
+
+    Site& add(const std::string& path, std::function<Page()> factory) {
+        entries_.push_back({path, nullptr, std::move(factory)});
+        return *this;
+    }
+
+    // Sync policy for each page and asset (see SyncPolicy)
+    Site& sync(SyncPolicy policy) { sync_ = policy; batch_size_ = 0; return *this; }
+    // Sync through a SyncBatch of this size instead
+    Site& batched_sync(size_t max_pending = 256) { batch_size_ = max_pending; return *this; }
+
+    // Rewrite only pages whose content changed since the last build, going
+    // by the hashes kept in the manifest file at path (see BuildManifest).
+    // The manifest is saved after the build. A page is recorded only once it
+    // is in place, so pages that failed, in a batched commit too, are
+    // written again next time.
+    Site& manifest(const std::string& path) { manifest_path_ = path; return *this; }
+
+    // Also write .gz (and .zst) copies of every page and asset; see Precompress
+    Site& precompress(int gzip_level = 6, int zstd_level = 0) {
+        precompress_.gzip = gzip_level;
+        precompress_.zstd = zstd_level;
+        return *this;
+    }
+
+    // Create missing directories above each page (off by default)
+    Site& create_directories(bool on = true) { create_directories_ = on; return *this; }
+
+    size_t size() const { return entries_.size(); }
+
+    // Builds every page and waits for all of them. A factory's exception is
+    // rethrown once the other pages are done.
+    SiteReport build() const {
+        using clock = std::chrono::steady_clock;
+        clock::time_point start = clock::now();
+
+        SiteReport report;
+        report.pages.resize(entries_.size());
+        AssetLog assets;
+        std::optional<BuildManifest> manifest;
+        if (!manifest_path_.empty()) manifest.emplace(manifest_path_);
+        std::optional<SyncBatch> batch;
+        if (batch_size_ > 0) batch.emplace(batch_size_);
+        // Each page's result from the batch, set by whichever thread commits it
+        std::vector<WriteResult> committed(entries_.size());
+
+        // Self-hosted fonts are subset once, to the characters of every page
+        // that uses them, so all pages link the same font files. Pages
+        // without fonts are written in the first pass; the others only add
+        // their characters and are built and written again in the second.
+        std::mutex font_mutex;
+        std::set<char32_t> font_characters;
+        std::vector<char> second_pass(entries_.size(), 0);
+
+        auto run = [this, &report, &assets, &manifest, &batch, &committed, &font_mutex, &font_characters,
+                    &second_pass](size_t i, bool first) {
+            AssetLogScope scope(assets);
+            const Entry& entry = entries_[i];
+            PageTiming& timing = report.pages[i];
+            timing.path = entry.path;
+
+            clock::time_point began = clock::now();
+            std::optional<Page> built;
+            const Page* page = entry.page.get();
+            if (!page) page = &built.emplace(entry.factory());
+            std::set<char32_t> characters;
+            if (first && page->font_characters(characters)) {
+                std::lock_guard<std::mutex> lock(font_mutex);
+                font_characters.insert(characters.begin(), characters.end());
+                second_pass[i] = 1;
+                timing.build = clock::now() - began;
+                return;
+            }
+            clock::time_point ready = clock::now();
+
+            WriteOptions options;
+            options.sync = sync_;
+            options.batch = batch ? &*batch : nullptr;
+            options.manifest = manifest ? &*manifest : nullptr;
+            options.precompress = precompress_;
+            if (batch) options.committed = [&committed, i](const WriteResult& result) { committed[i] = result; };
+            timing.result = create_directories_ ? make_parents(entry.path) : WriteResult();
+            if (timing.result) timing.result = page->render_to_file(entry.path, options);
+            timing.build += ready - began;
+            timing.write = clock::now() - ready;
+        };
+
+        // A factory's exception waits until every page has been tried
+        std::exception_ptr error;
+        {
+            TaskGroup group(*pool_);
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                group.run([&run, i] { run(i, true); });
+            }
+            try { group.wait(); } catch (...) { error = std::current_exception(); }
+        }
+        {
+            TaskGroup group(*pool_);
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                if (!second_pass[i]) continue;
+                group.run([&run, &font_characters, i] {
+                    FontCharactersScope fonts(font_characters);
+                    run(i, false);
+                });
+            }
+            try { group.wait(); } catch (...) { if (!error) error = std::current_exception(); }
+        }
+        if (error) std::rethrow_exception(error);
+
+        if (batch) {
+            report.commit = batch->commit();
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                if (report.pages[i].result && !committed[i]) report.pages[i].result = committed[i];
+            }
+        }
+        if (manifest) report.manifest = manifest->save(batch_size_ > 0 ? SyncPolicy::EachFile : sync_);
+        report.total = clock::now() - start;
+        return report;
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const Page> page;
+        std::function<Page()> factory;
+    };
+
+    static WriteResult make_parents(const std::string& path) {
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            WriteResult made = output_detail::make_dir(path.substr(0, slash));
+            if (!made) return made;
+        }
+        return {};
+    }
+
+    ThreadPool* pool_;
+    std::vector<Entry> entries_;
+    SyncPolicy sync_ = SyncPolicy::None;
+    size_t batch_size_ = 0;
+    std::string manifest_path_;
+    Precompress precompress_;
+    bool create_directories_ = false;
+};
+
+}
@@ -1,6 +1,13 @@
 #pragma once
 
+#include "sink.hpp"
+
+#include <initializer_list>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace zero_js 
 {
@@ -50,6 +57,7 @@ struct Theme
     static const ColorScheme dark_colors;
     static const ColorScheme light_colors;
     static const ColorScheme cream_colors;
+    static const ColorScheme variable_colors;
 
     const ColorScheme& get_colors() const 
     {
@@ -85,6 +93,8 @@ struct Theme
     static constexpr const char* font_size_xl = "20px";
     static constexpr const char* font_size_2xl = "28px";
      static constexpr const char* font_size_3xl = "36px";
+
+    static constexpr const char* font_family = "'IBM Plex Mono', 'Consolas', 'Monaco', monospace";
 };
 
 const ColorScheme Theme::dark_colors =
@@ -180,1116 +190,1522 @@ const ColorScheme Theme::cream_colors =
     "#268bd2"  // info
 };
 
-//add more colour schemes if needed here, and update the switch case
+// More colour schemes can be registered at run time with ThemeRegistry
+// (themes.hpp)
 
-inline std::string generate_css(const Theme& theme = Theme{}) 
+// Every colour as a reference to its custom property, for stylesheets whose
+// rules are shared by several schemes (see generate_all_themes_css)
+const ColorScheme Theme::variable_colors =
 {
-    const auto& colors = theme.get_colors();
-
-    // Select colors based on mode
-    const char* bg_page = colors.bg_page;
-    const char* bg_card = colors.bg_card;
-    const char* bg_card_hover = colors.bg_card_hover;
-    const char* bg_input = colors.bg_input;
-    const char* bg_navbar = colors.bg_navbar;
-    const char* bg_sidebar = colors.bg_sidebar;
-    const char* bg_button = colors.bg_button;
-    const char* bg_button_hover = colors.bg_button_hover;
-    const char* bg_button_secondary = colors.bg_button_secondary;
-    const char* bg_button_secondary_hover = colors.bg_button_secondary_hover;
-    const char* bg_accent = colors.bg_accent;
-    const char* text_primary = colors.text_primary;
-    const char* text_secondary = colors.text_secondary;
-    const char* text_muted = colors.text_muted;
-    const char* text_button = colors.text_button;
-    const char* text_accent = colors.text_accent;
-    const char* text_link = colors.text_link;
-    const char* border = colors.border;
-    const char* border_subtle = colors.border_subtle;
-    const char* border_focus = colors.border_focus;
-    const char* border_accent = colors.border_accent;
-    const char* shadow = colors.shadow;
-    const char* shadow_lg = colors.shadow_lg;
-    const char* success = colors.success;
-    const char* warning = colors.warning;
-    const char* error = colors.error;
-    const char* info = colors.info;
-
-    // Font selection based on theme
-    std::string font_family = "'IBM Plex Mono', 'Consolas', 'Monaco', monospace";
-
-    std::string font_import = "@import url('https://fonts.googleapis.com/css2?family=IBM+Plex+Mono:wght@400;500;600;700&display=swap');";
-
-    return font_import + std::string(R"(
-
-*, *::before, *::after {
-    box-sizing: border-box;
-    margin: 0;
-    padding: 0;
-}
-
-html {
-    font-family: )") + font_family + R"(;
-    font-size: )" + Theme::font_size_base + R"(;
-    line-height: 1.5;
-    color: )" + text_primary + R"(;
-    background-color: )" + bg_page + R"(;
-    -webkit-font-smoothing: antialiased;
-    -moz-osx-font-smoothing: grayscale;
-    
-    /* CSS Custom Properties for Components */
-    --ew-bg-page: )" + bg_page + R"(;
-    --ew-bg-card: )" + bg_card + R"(;
-    --ew-bg-card-hover: )" + bg_card_hover + R"(;
-    --ew-bg-input: )" + bg_input + R"(;
-    --ew-bg-navbar: )" + bg_navbar + R"(;
-    --ew-bg-sidebar: )" + bg_sidebar + R"(;
-    --ew-bg-button: )" + bg_button + R"(;
-    --ew-bg-button-hover: )" + bg_button_hover + R"(;
-    --ew-bg-button-secondary: )" + bg_button_secondary + R"(;
-    --ew-bg-button-secondary-hover: )" + bg_button_secondary_hover + R"(;
-    --ew-bg-accent: )" + bg_accent + R"(;
-    --ew-text: )" + text_primary + R"(;
-    --ew-text-secondary: )" + text_secondary + R"(;
-    --ew-text-muted: )" + text_muted + R"(;
-    --ew-text-button: )" + text_button + R"(;
-    --ew-text-accent: )" + text_accent + R"(;
-    --ew-text-link: )" + text_link + R"(;
-    --ew-border: )" + border + R"(;
-    --ew-border-subtle: )" + border_subtle + R"(;
-    --ew-border-focus: )" + border_focus + R"(;
-    --ew-border-accent: )" + border_accent + R"(;
-    --ew-shadow: )" + shadow + R"(;
-    --ew-shadow-lg: )" + shadow_lg + R"(;
-    --ew-success: )" + success + R"(;
-    --ew-warning: )" + warning + R"(;
-    --ew-error: )" + error + R"(;
-    --ew-info: )" + info + R"(;
-    
-    /* Chart-specific colors */
-    --ew-primary: )" + bg_button + R"(;
-    --ew-secondary: )" + success + R"(;
-}
-
-body {
-    min-height: 100vh;
-}
-
-/* ============================================
-   LAYOUT COMPONENTS
-   ============================================ */
-
-.ew-app {
-    display: flex;
-    flex-direction: column;
-    min-height: 100vh;
-}
-
-.ew-app-body {
-    display: flex;
-    flex: 1;
-}
-
-.ew-main {
-    flex: 1;
-    padding: )" + Theme::spacing_lg + R"(;
-    overflow-y: auto;
-}
-
-.ew-page {
-    max-width: 1400px;
-    margin: 0 auto;
-    padding: )" + Theme::spacing_lg + R"(;
-}
-
-/* ============================================
-   NAVBAR - Angular
-   ============================================ */
-
-.ew-navbar {
-    display: flex;
-    align-items: center;
-    justify-content: space-between;
-    padding: )" + Theme::spacing_sm + " " + Theme::spacing_lg + R"(;
-    background: )" + bg_navbar + R"(;
-    border-bottom: 1px solid )" + border_subtle + R"(;
-    position: sticky;
-    top: 0;
-    z-index: 100;
-}
-
-.ew-navbar-brand {
-    font-size: )" + Theme::font_size_lg + R"(;
-    font-weight: 600;
-    color: )" + text_primary + R"(;
-    text-decoration: none;
-    letter-spacing: -0.01em;
-    display: flex;
-    align-items: center;
-    gap: )" + Theme::spacing_sm + R"(;
-}
-
-.ew-navbar-nav {
-    display: flex;
-    align-items: center;
-    gap: 0;
-    list-style: none;
-}
-
-.ew-navbar-item {
-    padding: )" + Theme::spacing_sm + " " + Theme::spacing_md + R"(;
-    color: )" + text_secondary + R"(;
-    text-decoration: none;
-    font-weight: 500;
-    font-size: )" + Theme::font_size_sm + R"(;
-    border-bottom: 1px solid transparent;
-    transition: all 0.15s ease;
-}
-
-.ew-navbar-item:hover {
-    color: )" + text_primary + R"(;
-    background: )" + bg_card_hover + R"(;
-}
-
-.ew-navbar-item-active {
-    color: )" + text_accent + R"(;
-    border-bottom-color: )" + border_accent + R"(;
-}
-
-.ew-navbar-actions {
-    display: flex;
-    align-items: center;
-    gap: )" + Theme::spacing_sm + R"(;
-}
-
-/* ============================================
-   SIDEBAR - Angular
-   ============================================ */
-
-.ew-sidebar {
-    width: 240px;
-    min-width: 240px;
-    background: )" + bg_sidebar + R"(;
-    border-right: 1px solid )" + border_subtle + R"(;
-    padding: )" + Theme::spacing_md + R"( 0;
-    overflow-y: auto;
-    height: calc(100vh - 41px);
-    position: sticky;
-    top: 41px;
-}
-
-.ew-sidebar-section {
-    margin-bottom: )" + Theme::spacing_lg + R"(;
-}
-
-.ew-sidebar-title {
-    font-size: )" + Theme::font_size_xs + R"(;
-    font-weight: 600;
-    text-transform: uppercase;
-    letter-spacing: 0.05em;
-    color: )" + text_muted + R"(;
-    padding: )" + Theme::spacing_sm + " " + Theme::spacing_md + R"(;
-    margin-bottom: )" + Theme::spacing_xs + R"(;
-    border-left: 2px solid transparent;
-}
-
-.ew-sidebar-nav {
-    list-style: none;
-}
-
-.ew-sidebar-item {
-    display: flex;
-    align-items: center;
-    gap: )" + Theme::spacing_sm + R"(;
-    padding: )" + Theme::spacing_sm + " " + Theme::spacing_md + R"(;
-    color: )" + text_secondary + R"(;
-    text-decoration: none;
-    font-weight: 400;
-    font-size: )" + Theme::font_size_sm + R"(;
-    border-left: 2px solid transparent;
-    transition: all 0.15s ease;
-}
-
-.ew-sidebar-item:hover {
-    color: )" + text_primary + R"(;
-    border-left-color: )" + border_subtle + R"(;
-}
-
-.ew-sidebar-item-active {
-    color: )" + text_accent + R"(;
-    border-left-color: )" + border_accent + R"(;
-    font-weight: 500;
-}
-
-/* ============================================
-   CARDS - Clean, Minimal
-   ============================================ */
-
-.ew-card {
-    background: )" + bg_card + R"(;
-    border: 1px solid )" + border_subtle + R"(;
-    padding: )" + Theme::spacing_lg + R"(;
-    margin-bottom: )" + Theme::spacing_sm + R"(;
-    transition: border-color 0.15s ease;
-}
-
-.ew-card:hover {
-    border-color: )" + border + R"(;
-}
-
-.ew-card-title {
-    font-size: )" + Theme::font_size_base + R"(;
-    font-weight: 600;
-    margin-bottom: )" + Theme::spacing_md + R"(;
-    color: )" + text_primary + R"(;
-    padding-bottom: )" + Theme::spacing_sm + R"(;
-    border-bottom: 1px solid )" + border_subtle + R"(;
-}
-
-.ew-card-compact {
-    padding: )" + Theme::spacing_md + R"(;
-}
-
-.ew-card-accent {
-    border-left: 2px solid )" + border_accent + R"(;
-}
-
-/* ============================================
-   BOX & CONTAINERS
-   ============================================ */
-
-.ew-box {
-    padding: )" + Theme::spacing_md + R"(;
-}
-
-.ew-box-bordered {
-    border: 1px solid )" + border_subtle + R"(;
-}
-
-/* ============================================
-   TYPOGRAPHY - Clean
-   ============================================ */
-
-.ew-text {
-    margin-bottom: )" + Theme::spacing_sm + R"(;
-    color: )" + text_primary + R"(;
-    line-height: 1.6;
-}
-
-.ew-text-secondary {
-    color: )" + text_secondary + R"(;
-}
-
-.ew-text-muted {
-    color: )" + text_muted + R"(;
-}
-
-.ew-text-accent {
-    color: )" + text_accent + R"(;
-}
-
-.ew-text-success {
-    color: )" + success + R"(;
-}
-
-.ew-text-warning {
-    color: )" + warning + R"(;
-}
-
-.ew-text-error {
-    color: )" + error + R"(;
-}
-
-.ew-heading-1 {
-    font-size: )" + Theme::font_size_2xl + R"(;
-    font-weight: 600;
-    margin-bottom: )" + Theme::spacing_md + R"(;
-    letter-spacing: -0.02em;
-    line-height: 1.2;
-}
-
-.ew-heading-2 {
-    font-size: )" + Theme::font_size_xl + R"(;
-    font-weight: 600;
-    margin-bottom: )" + Theme::spacing_md + R"(;
-    line-height: 1.3;
-    letter-spacing: -0.01em;
-}
-
-.ew-heading-3 {
-    font-size: )" + Theme::font_size_lg + R"(;
-    font-weight: 600;
-    margin-bottom: )" + Theme::spacing_sm + R"(;
-    line-height: 1.4;
-}
-
-/* ============================================
-   BUTTONS - Clean, Minimal
-   ============================================ */
-
-.ew-button {
-    display: inline-flex;
-    align-items: center;
-    justify-content: center;
-    gap: )" + Theme::spacing_sm + R"(;
-    padding: 8px 16px;
-    font-size: )" + Theme::font_size_sm + R"(;
-    font-weight: 500;
-    font-family: inherit;
-    border: 1px solid transparent;
-    cursor: pointer;
-    transition: all 0.15s ease;
-    text-decoration: none;
-}
-
-.ew-button:active {
-    transform: translateY(1px);
-}
-
-.ew-button-primary {
-    background-color: )" + bg_button + R"(;
-    color: )" + text_button + R"(;
-    border-color: )" + bg_button + R"(;
-}
-
-.ew-button-primary:hover {
-    background-color: )" + bg_button_hover + R"(;
-    border-color: )" + bg_button_hover + R"(;
-}
-
-.ew-button-secondary {
-    background-color: )" + bg_button_secondary + R"(;
-    color: )" + text_primary + R"(;
-    border-color: )" + border_subtle + R"(;
-}
-
-.ew-button-secondary:hover {
-    background-color: )" + bg_button_secondary_hover + R"(;
-    border-color: )" + border + R"(;
-}
-
-.ew-button-outline {
-    background-color: transparent;
-    color: )" + text_accent + R"(;
-    border-color: )" + border_accent + R"(;
-}
-
-.ew-button-outline:hover {
-    background-color: )" + text_accent + R"(;
-    color: )" + bg_page + R"(;
-}
-
-.ew-button-ghost {
-    background-color: transparent;
-    color: )" + text_secondary + R"(;
-    border-color: transparent;
-}
-
-.ew-button-ghost:hover {
-    color: )" + text_primary + R"(;
-}
-
-.ew-button-sm {
-    padding: 4px 10px;
-    font-size: )" + Theme::font_size_xs + R"(;
-}
-
-.ew-button-xs {
-    padding: 2px 8px;
-    font-size: )" + Theme::font_size_xs + R"(;
-}
-
-.ew-button-lg {
-    padding: 12px 24px;
-    font-size: )" + Theme::font_size_base + R"(;
-}
-
-/* ============================================
-   CHART COMPONENTS
-   ============================================ */
-
-.ew-chart-container {
-    display: flex;
-    flex-direction: column;
-    gap: )" + Theme::spacing_sm + R"(;
-    padding: )" + Theme::spacing_md + R"(;
-    background: var(--ew-bg-card);
-    border: 1px solid var(--ew-border);
-    border-radius: )" + Theme::radius_md + R"(;
-}
-
-.ew-chart-title {
-    font-size: )" + Theme::font_size_lg + R"(;
-    font-weight: 600;
-    color: var(--ew-text);
-    text-align: center;
-    margin-bottom: )" + Theme::spacing_sm + R"(;
-}
-
-.ew-chart {
-    width: 100%;
-    height: auto;
-    background: transparent;
-}
-
-.ew-chart-legend {
-    display: flex;
-    flex-wrap: wrap;
-    gap: )" + Theme::spacing_md + R"(;
-    justify-content: center;
-    margin-top: )" + Theme::spacing_sm + R"(;
-}
-
-.ew-chart-legend-item {
-    display: flex;
-    align-items: center;
-    gap: )" + Theme::spacing_xs + R"(;
-    font-size: )" + Theme::font_size_sm + R"(;
-    color: var(--ew-text);
-}
-
-.ew-chart-legend-color {
-    width: 12px;
-    height: 12px;
-    border-radius: 2px;
-}
-
-/* ============================================
-   LAYOUT UTILITIES
-   ============================================ */
-
-.ew-row {
-    display: flex;
-    flex-direction: row;
-    gap: )" + Theme::spacing_md + R"(;
-}
-
-.ew-row-wrap {
-    flex-wrap: wrap;
-}
-
-.ew-column {
-    display: flex;
-    flex-direction: column;
-    gap: )" + Theme::spacing_md + R"(;
-}
-
-.ew-grid {
-    display: grid;
-    gap: )" + Theme::spacing_sm + R"(;
-}
-
-.ew-grid-2 { grid-template-columns: repeat(2, 1fr); }
-.ew-grid-3 { grid-template-columns: repeat(3, 1fr); }
-.ew-grid-4 { grid-template-columns: repeat(4, 1fr); }
-
-/* ============================================
-   FORM ELEMENTS - Angular
-   ============================================ */
-
-.ew-input {
-    width: 100%;
-    padding: 8px 12px;
-    font-size: )" + Theme::font_size_sm + R"(;
-    font-family: inherit;
-    border: 1px solid )" + border_subtle + R"(;
-    background: )" + bg_input + R"(;
-    color: )" + text_primary + R"(;
-    transition: border-color 0.15s ease;
-}
-
-.ew-input:focus {
-    outline: none;
-    border-color: )" + border_focus + R"(;
-}
-
-.ew-input::placeholder {
-    color: )" + text_muted + R"(;
-}
-
-.ew-label {
-    display: block;
-    font-size: )" + Theme::font_size_xs + R"(;
-    font-weight: 500;
-    margin-bottom: )" + Theme::spacing_xs + R"(;
-    color: )" + text_secondary + R"(;
-}
-
-.ew-form-group {
-    margin-bottom: )" + Theme::spacing_md + R"(;
-}
-
-/* ============================================
-   UTILITIES
-   ============================================ */
-
-.ew-divider {
-    border: none;
-    border-top: 1px solid )" + border_subtle + R"(;
-    margin: )" + Theme::spacing_lg + R"( 0;
-}
-
-.ew-spacer { height: )" + Theme::spacing_md + R"(; }
-.ew-spacer-sm { height: )" + Theme::spacing_sm + R"(; }
-.ew-spacer-lg { height: )" + Theme::spacing_lg + R"(; }
-.ew-spacer-xl { height: )" + Theme::spacing_xl + R"(; }
-
-.ew-link {
-    color: )" + text_link + R"(;
-    text-decoration: none;
-    font-weight: 600;
-    border-bottom: 1px solid transparent;
-}
-
-.ew-link:hover {
-    border-bottom-color: )" + text_link + R"(;
-}
-
-.ew-image {
-    max-width: 100%;
-    height: auto;
-}
-
-.ew-center { text-align: center; }
-.ew-right { text-align: right; }
-.ew-flex-grow { flex-grow: 1; }
-.ew-flex-shrink-0 { flex-shrink: 0; }
-
-.ew-center-content { justify-content: center; }
-
-.ew-gap-sm { gap: )" + Theme::spacing_sm + R"(; }
-.ew-gap-lg { gap: )" + Theme::spacing_lg + R"(; }
-.ew-gap-xl { gap: )" + Theme::spacing_xl + R"(; }
-
-/* ============================================
-   BADGE - Clean
-   ============================================ */
-
-.ew-badge {
-    display: inline-flex;
-    align-items: center;
-    padding: 2px 8px;
-    font-size: )" + Theme::font_size_xs + R"(;
-    font-weight: 500;
-    border: 1px solid )" + border_accent + R"(;
-    background: transparent;
-    color: )" + text_accent + R"(;
-}
-
-.ew-badge-success {
-    border-color: )" + success + R"(;
-    color: )" + success + R"(;
-}
-
-.ew-badge-warning {
-    border-color: )" + warning + R"(;
-    color: )" + warning + R"(;
-}
-
-.ew-badge-error {
-    border-color: )" + error + R"(;
-    color: )" + error + R"(;
-}
-
-/* ============================================
-   STAT CARD - Clean
-   ============================================ */
-
-.ew-stat {
-    display: flex;
-    flex-direction: column;
-}
-
-.ew-stat-label {
-    font-size: )" + Theme::font_size_xs + R"(;
-    font-weight: 500;
-    color: )" + text_muted + R"(;
-    margin-bottom: )" + Theme::spacing_xs + R"(;
-}
-
-.ew-stat-value {
-    font-size: )" + Theme::font_size_2xl + R"(;
-    font-weight: 700;
-    color: )" + text_primary + R"(;
-    line-height: 1;
-    font-variant-numeric: tabular-nums;
-}
-
-.ew-stat-change {
-    font-size: )" + Theme::font_size_sm + R"(;
-    font-weight: 700;
-    margin-top: )" + Theme::spacing_sm + R"(;
-}
-
-.ew-stat-change-up {
-    color: )" + success + R"(;
-}
-
-.ew-stat-change-down {
-    color: )" + error + R"(;
-}
-
-/* ============================================
-   CODE BLOCK - Terminal Style
-   ============================================ */
-
-.ew-code {
-    font-family: 'IBM Plex Mono', monospace;
-    background: )" + bg_card_hover + R"(;
-    padding: 1px 4px;
-    font-size: )" + Theme::font_size_sm + R"(;
-    color: )" + text_accent + R"(;
-}
-
-.ew-code-block {
-    background: )" + bg_card + R"(;
-    border: 1px solid )" + border_subtle + R"(;
-    padding: 0;
-    overflow: hidden;
-}
-
-.ew-code-block .ew-card-title,
-.ew-code-block > .ew-row:first-child {
-    background: )" + bg_card_hover + R"(;
-    border-bottom: 1px solid )" + border_subtle + R"(;
-    padding: )" + Theme::spacing_sm + " " + Theme::spacing_md + R"(;
-    margin: 0;
-}
-
-.ew-code-block .ew-code {
-    display: block;
-    padding: )" + Theme::spacing_md + R"(;
-    margin: 0;
-    background: transparent;
-    white-space: pre;
-    overflow-x: auto;
-    line-height: 1.5;
-    color: )" + text_primary + R"(;
-}
-
-/* ============================================
-   RESPONSIVE DESIGN SYSTEM
-   ============================================ */
-
-/* Mobile-first responsive utilities */
-.ew-hidden-mobile { display: none; }
-.ew-hidden-tablet { display: initial; }
-.ew-hidden-desktop { display: initial; }
-
-@media (min-width: 576px) {
-    .ew-hidden-mobile { display: initial; }
-    .ew-hidden-tablet { display: none; }
-}
-
-@media (min-width: 1024px) {
-    .ew-hidden-tablet { display: initial; }
-    .ew-hidden-desktop { display: none; }
-}
-
-@media (min-width: 1200px) {
-    .ew-hidden-desktop { display: initial; }
-}
-
-/* Responsive spacing utilities */
-.ew-p-sm { padding: )" + Theme::spacing_sm + R"(; }
-.ew-p-md { padding: )" + Theme::spacing_md + R"(; }
-.ew-p-lg { padding: )" + Theme::spacing_lg + R"(; }
-.ew-p-xl { padding: )" + Theme::spacing_xl + R"(; }
-
-.ew-m-sm { margin: )" + Theme::spacing_sm + R"(; }
-.ew-m-md { margin: )" + Theme::spacing_md + R"(; }
-.ew-m-lg { margin: )" + Theme::spacing_lg + R"(; }
-.ew-m-xl { margin: )" + Theme::spacing_xl + R"(; }
-
-.ew-mb-sm { margin-bottom: )" + Theme::spacing_sm + R"(; }
-.ew-mb-md { margin-bottom: )" + Theme::spacing_md + R"(; }
-.ew-mb-lg { margin-bottom: )" + Theme::spacing_lg + R"(; }
-.ew-mb-xl { margin-bottom: )" + Theme::spacing_xl + R"(; }
-
-/* Responsive text sizes */
-.ew-text-xs { font-size: 0.75rem; line-height: 1rem; }
-.ew-text-sm { font-size: 0.875rem; line-height: 1.25rem; }
-.ew-text-base { font-size: 1rem; line-height: 1.5rem; }
-.ew-text-lg { font-size: 1.125rem; line-height: 1.75rem; }
-.ew-text-xl { font-size: 1.25rem; line-height: 1.75rem; }
-.ew-text-2xl { font-size: 1.5rem; line-height: 2rem; }
-.ew-text-3xl { font-size: 1.875rem; line-height: 2.25rem; }
-
-/* Touch-friendly button sizes */
-.ew-btn-touch {
-    min-height: 44px;
-    min-width: 44px;
-    padding: )" + Theme::spacing_md + R"(;
-}
-
-/* Mobile-specific utilities */
-.ew-row-mobile-stack {
-    flex-direction: row;
-}
-
-.ew-center-mobile {
-    justify-content: flex-start;
-    text-align: left;
-}
+    "var(--ew-bg-page)",
+    "var(--ew-bg-card)",
+    "var(--ew-bg-card-hover)",
+    "var(--ew-bg-input)",
+    "var(--ew-bg-navbar)",
+    "var(--ew-bg-sidebar)",
+    "var(--ew-bg-button)",
+    "var(--ew-bg-button-hover)",
+    "var(--ew-bg-button-secondary)",
+    "var(--ew-bg-button-secondary-hover)",
+    "var(--ew-bg-accent)",
+    "var(--ew-text)",
+    "var(--ew-text-secondary)",
+    "var(--ew-text-muted)",
+    "var(--ew-text-button)",
+    "var(--ew-text-accent)",
+    "var(--ew-text-link)",
+    "var(--ew-border)",
+    "var(--ew-border-subtle)",
+    "var(--ew-border-focus)",
+    "var(--ew-border-accent)",
+    "var(--ew-shadow)",
+    "var(--ew-shadow-lg)",
+    "var(--ew-success)",
+    "var(--ew-warning)",
+    "var(--ew-error)",
+    "var(--ew-info)"
+};
 
-@media (max-width: 768px) {
-    .ew-row-mobile-stack {
-        flex-direction: column;
-        align-items: stretch;
-        gap: )" + Theme::spacing_md + R"(;
-    }
+// ============================================================================
+// Stylesheet Rules
+// ============================================================================
+
+// The built-in stylesheet, kept as a table of rules instead of one string so
+// it can be measured, pruned and written in any layout by a single loop.
+// Values refer to theme tokens as $name (see css_token). context is the
+// at-rule a rule sits in, such as "@media (max-width: 768px)" or
+// "@keyframes blink", and empty at the top level; consecutive rules with the
+// same context are written inside one block.
+struct CssDeclaration
+{
+    const char* property;
+    const char* value;
+};
 
-    .ew-center-mobile {
-        justify-content: center;
-        text-align: center;
-    }
-}
+struct CssRule
+{
+    const char* context;
+    const char* selector;
+    std::initializer_list<CssDeclaration> declarations;
+};
 
-/* Responsive grid utilities */
-.ew-grid-responsive {
-    display: grid;
-    gap: )" + Theme::spacing_md + R"(;
-    grid-template-columns: 1fr;
-}
+inline const CssRule css_rules[] =
+{
+    {"", "*, *::before, *::after", {
+        {"box-sizing", "border-box"},
+        {"margin", "0"},
+        {"padding", "0"},
+    }},
+    {"", "html", {
+        {"font-family", "$font_family"},
+        {"font-size", "$font_size_base"},
+        {"line-height", "1.5"},
+        {"color", "$text_primary"},
+        {"background-color", "$bg_page"},
+        {"-webkit-font-smoothing", "antialiased"},
+        {"-moz-osx-font-smoothing", "grayscale"},
+        // CSS Custom Properties for Components
+        {"--ew-bg-page", "$bg_page"},
+        {"--ew-bg-card", "$bg_card"},
+        {"--ew-bg-card-hover", "$bg_card_hover"},
+        {"--ew-bg-input", "$bg_input"},
+        {"--ew-bg-navbar", "$bg_navbar"},
+        {"--ew-bg-sidebar", "$bg_sidebar"},
+        {"--ew-bg-button", "$bg_button"},
+        {"--ew-bg-button-hover", "$bg_button_hover"},
+        {"--ew-bg-button-secondary", "$bg_button_secondary"},
+        {"--ew-bg-button-secondary-hover", "$bg_button_secondary_hover"},
+        {"--ew-bg-accent", "$bg_accent"},
+        {"--ew-text", "$text_primary"},
+        {"--ew-text-secondary", "$text_secondary"},
+        {"--ew-text-muted", "$text_muted"},
+        {"--ew-text-button", "$text_button"},
+        {"--ew-text-accent", "$text_accent"},
+        {"--ew-text-link", "$text_link"},
+        {"--ew-border", "$border"},
+        {"--ew-border-subtle", "$border_subtle"},
+        {"--ew-border-focus", "$border_focus"},
+        {"--ew-border-accent", "$border_accent"},
+        {"--ew-shadow", "$shadow"},
+        {"--ew-shadow-lg", "$shadow_lg"},
+        {"--ew-success", "$success"},
+        {"--ew-warning", "$warning"},
+        {"--ew-error", "$error"},
+        {"--ew-info", "$info"},
+        // Chart-specific colors
+        {"--ew-primary", "$bg_button"},
+        {"--ew-secondary", "$success"},
+    }},
+    {"", "body", {
+        {"min-height", "100vh"},
+    }},
+
+    // LAYOUT COMPONENTS
+    {"", ".ew-app", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+        {"min-height", "100vh"},
+    }},
+    {"", ".ew-app-body", {
+        {"display", "flex"},
+        {"flex", "1"},
+    }},
+    {"", ".ew-main", {
+        {"flex", "1"},
+        {"padding", "$spacing_lg"},
+        {"overflow-y", "auto"},
+    }},
+    {"", ".ew-page", {
+        {"max-width", "1400px"},
+        {"margin", "0 auto"},
+        {"padding", "$spacing_lg"},
+    }},
+
+    // NAVBAR - Angular
+    {"", ".ew-navbar", {
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"justify-content", "space-between"},
+        {"padding", "$spacing_sm $spacing_lg"},
+        {"background", "$bg_navbar"},
+        {"border-bottom", "1px solid $border_subtle"},
+        {"position", "sticky"},
+        {"top", "0"},
+        {"z-index", "100"},
+    }},
+    {"", ".ew-navbar-brand", {
+        {"font-size", "$font_size_lg"},
+        {"font-weight", "600"},
+        {"color", "$text_primary"},
+        {"text-decoration", "none"},
+        {"letter-spacing", "-0.01em"},
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"gap", "$spacing_sm"},
+    }},
+    {"", ".ew-navbar-nav", {
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"gap", "0"},
+        {"list-style", "none"},
+    }},
+    {"", ".ew-navbar-item", {
+        {"padding", "$spacing_sm $spacing_md"},
+        {"color", "$text_secondary"},
+        {"text-decoration", "none"},
+        {"font-weight", "500"},
+        {"font-size", "$font_size_sm"},
+        {"border-bottom", "1px solid transparent"},
+        {"transition", "all 0.15s ease"},
+    }},
+    {"", ".ew-navbar-item:hover", {
+        {"color", "$text_primary"},
+        {"background", "$bg_card_hover"},
+    }},
+    {"", ".ew-navbar-item-active", {
+        {"color", "$text_accent"},
+        {"border-bottom-color", "$border_accent"},
+    }},
+    {"", ".ew-navbar-actions", {
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"gap", "$spacing_sm"},
+    }},
+
+    // SIDEBAR - Angular
+    {"", ".ew-sidebar", {
+        {"width", "240px"},
+        {"min-width", "240px"},
+        {"background", "$bg_sidebar"},
+        {"border-right", "1px solid $border_subtle"},
+        {"padding", "$spacing_md 0"},
+        {"overflow-y", "auto"},
+        {"height", "calc(100vh - 41px)"},
+        {"position", "sticky"},
+        {"top", "41px"},
+    }},
+    {"", ".ew-sidebar-section", {
+        {"margin-bottom", "$spacing_lg"},
+    }},
+    {"", ".ew-sidebar-title", {
+        {"font-size", "$font_size_xs"},
+        {"font-weight", "600"},
+        {"text-transform", "uppercase"},
+        {"letter-spacing", "0.05em"},
+        {"color", "$text_muted"},
+        {"padding", "$spacing_sm $spacing_md"},
+        {"margin-bottom", "$spacing_xs"},
+        {"border-left", "2px solid transparent"},
+    }},
+    {"", ".ew-sidebar-nav", {
+        {"list-style", "none"},
+    }},
+    {"", ".ew-sidebar-item", {
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"gap", "$spacing_sm"},
+        {"padding", "$spacing_sm $spacing_md"},
+        {"color", "$text_secondary"},
+        {"text-decoration", "none"},
+        {"font-weight", "400"},
+        {"font-size", "$font_size_sm"},
+        {"border-left", "2px solid transparent"},
+        {"transition", "all 0.15s ease"},
+    }},
+    {"", ".ew-sidebar-item:hover", {
+        {"color", "$text_primary"},
+        {"border-left-color", "$border_subtle"},
+    }},
+    {"", ".ew-sidebar-item-active", {
+        {"color", "$text_accent"},
+        {"border-left-color", "$border_accent"},
+        {"font-weight", "500"},
+    }},
+
+    // CARDS - Clean, Minimal
+    {"", ".ew-card", {
+        {"background", "$bg_card"},
+        {"border", "1px solid $border_subtle"},
+        {"padding", "$spacing_lg"},
+        {"margin-bottom", "$spacing_sm"},
+        {"transition", "border-color 0.15s ease"},
+    }},
+    {"", ".ew-card:hover", {
+        {"border-color", "$border"},
+    }},
+    {"", ".ew-card-title", {
+        {"font-size", "$font_size_base"},
+        {"font-weight", "600"},
+        {"margin-bottom", "$spacing_md"},
+        {"color", "$text_primary"},
+        {"padding-bottom", "$spacing_sm"},
+        {"border-bottom", "1px solid $border_subtle"},
+    }},
+    {"", ".ew-card-compact", {
+        {"padding", "$spacing_md"},
+    }},
+    {"", ".ew-card-accent", {
+        {"border-left", "2px solid $border_accent"},
+    }},
+
+    // BOX & CONTAINERS
+    {"", ".ew-box", {
+        {"padding", "$spacing_md"},
+    }},
+    {"", ".ew-box-bordered", {
+        {"border", "1px solid $border_subtle"},
+    }},
+
+    // TYPOGRAPHY - Clean
+    {"", ".ew-text", {
+        {"margin-bottom", "$spacing_sm"},
+        {"color", "$text_primary"},
+        {"line-height", "1.6"},
+    }},
+    {"", ".ew-text-secondary", {
+        {"color", "$text_secondary"},
+    }},
+    {"", ".ew-text-muted", {
+        {"color", "$text_muted"},
+    }},
+    {"", ".ew-text-accent", {
+        {"color", "$text_accent"},
+    }},
+    {"", ".ew-text-success", {
+        {"color", "$success"},
+    }},
+    {"", ".ew-text-warning", {
+        {"color", "$warning"},
+    }},
+    {"", ".ew-text-error", {
+        {"color", "$error"},
+    }},
+    {"", ".ew-heading-1", {
+        {"font-size", "$font_size_2xl"},
+        {"font-weight", "600"},
+        {"margin-bottom", "$spacing_md"},
+        {"letter-spacing", "-0.02em"},
+        {"line-height", "1.2"},
+    }},
+    {"", ".ew-heading-2", {
+        {"font-size", "$font_size_xl"},
+        {"font-weight", "600"},
+        {"margin-bottom", "$spacing_md"},
+        {"line-height", "1.3"},
+        {"letter-spacing", "-0.01em"},
+    }},
+    {"", ".ew-heading-3", {
+        {"font-size", "$font_size_lg"},
+        {"font-weight", "600"},
+        {"margin-bottom", "$spacing_sm"},
+        {"line-height", "1.4"},
+    }},
+
+    // BUTTONS - Clean, Minimal
+    {"", ".ew-button", {
+        {"display", "inline-flex"},
+        {"align-items", "center"},
+        {"justify-content", "center"},
+        {"gap", "$spacing_sm"},
+        {"padding", "8px 16px"},
+        {"font-size", "$font_size_sm"},
+        {"font-weight", "500"},
+        {"font-family", "inherit"},
+        {"border", "1px solid transparent"},
+        {"cursor", "pointer"},
+        {"transition", "all 0.15s ease"},
+        {"text-decoration", "none"},
+    }},
+    {"", ".ew-button:active", {
+        {"transform", "translateY(1px)"},
+    }},
+    {"", ".ew-button-primary", {
+        {"background-color", "$bg_button"},
+        {"color", "$text_button"},
+        {"border-color", "$bg_button"},
+    }},
+    {"", ".ew-button-primary:hover", {
+        {"background-color", "$bg_button_hover"},
+        {"border-color", "$bg_button_hover"},
+    }},
+    {"", ".ew-button-secondary", {
+        {"background-color", "$bg_button_secondary"},
+        {"color", "$text_primary"},
+        {"border-color", "$border_subtle"},
+    }},
+    {"", ".ew-button-secondary:hover", {
+        {"background-color", "$bg_button_secondary_hover"},
+        {"border-color", "$border"},
+    }},
+    {"", ".ew-button-outline", {
+        {"background-color", "transparent"},
+        {"color", "$text_accent"},
+        {"border-color", "$border_accent"},
+    }},
+    {"", ".ew-button-outline:hover", {
+        {"background-color", "$text_accent"},
+        {"color", "$bg_page"},
+    }},
+    {"", ".ew-button-ghost", {
+        {"background-color", "transparent"},
+        {"color", "$text_secondary"},
+        {"border-color", "transparent"},
+    }},
+    {"", ".ew-button-ghost:hover", {
+        {"color", "$text_primary"},
+    }},
+    {"", ".ew-button-sm", {
+        {"padding", "4px 10px"},
+        {"font-size", "$font_size_xs"},
+    }},
+    {"", ".ew-button-xs", {
+        {"padding", "2px 8px"},
+        {"font-size", "$font_size_xs"},
+    }},
+    {"", ".ew-button-lg", {
+        {"padding", "12px 24px"},
+        {"font-size", "$font_size_base"},
+    }},
+
+    // CHART COMPONENTS
+    {"", ".ew-chart-container", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+        {"gap", "$spacing_sm"},
+        {"padding", "$spacing_md"},
+        {"background", "var(--ew-bg-card)"},
+        {"border", "1px solid var(--ew-border)"},
+        {"border-radius", "$radius_md"},
+    }},
+    {"", ".ew-chart-title", {
+        {"font-size", "$font_size_lg"},
+        {"font-weight", "600"},
+        {"color", "var(--ew-text)"},
+        {"text-align", "center"},
+        {"margin-bottom", "$spacing_sm"},
+    }},
+    {"", ".ew-chart", {
+        {"width", "100%"},
+        {"height", "auto"},
+        {"background", "transparent"},
+    }},
+    {"", ".ew-chart-legend", {
+        {"display", "flex"},
+        {"flex-wrap", "wrap"},
+        {"gap", "$spacing_md"},
+        {"justify-content", "center"},
+        {"margin-top", "$spacing_sm"},
+    }},
+    {"", ".ew-chart-legend-item", {
+        {"display", "flex"},
+        {"align-items", "center"},
+        {"gap", "$spacing_xs"},
+        {"font-size", "$font_size_sm"},
+        {"color", "var(--ew-text)"},
+    }},
+    {"", ".ew-chart-legend-color", {
+        {"width", "12px"},
+        {"height", "12px"},
+        {"border-radius", "2px"},
+    }},
+
+    // LAYOUT UTILITIES
+    {"", ".ew-row", {
+        {"display", "flex"},
+        {"flex-direction", "row"},
+        {"gap", "$spacing_md"},
+    }},
+    {"", ".ew-row-wrap", {
+        {"flex-wrap", "wrap"},
+    }},
+    {"", ".ew-column", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+        {"gap", "$spacing_md"},
+    }},
+    {"", ".ew-grid", {
+        {"display", "grid"},
+        {"gap", "$spacing_sm"},
+    }},
+    {"", ".ew-grid-2", {
+        {"grid-template-columns", "repeat(2, 1fr)"},
+    }},
+    {"", ".ew-grid-3", {
+        {"grid-template-columns", "repeat(3, 1fr)"},
+    }},
+    {"", ".ew-grid-4", {
+        {"grid-template-columns", "repeat(4, 1fr)"},
+    }},
+
+    // FORM ELEMENTS - Angular
+    {"", ".ew-input", {
+        {"width", "100%"},
+        {"padding", "8px 12px"},
+        {"font-size", "$font_size_sm"},
+        {"font-family", "inherit"},
+        {"border", "1px solid $border_subtle"},
+        {"background", "$bg_input"},
+        {"color", "$text_primary"},
+        {"transition", "border-color 0.15s ease"},
+    }},
+    {"", ".ew-input:focus", {
+        {"outline", "none"},
+        {"border-color", "$border_focus"},
+    }},
+    {"", ".ew-input::placeholder", {
+        {"color", "$text_muted"},
+    }},
+    {"", ".ew-label", {
+        {"display", "block"},
+        {"font-size", "$font_size_xs"},
+        {"font-weight", "500"},
+        {"margin-bottom", "$spacing_xs"},
+        {"color", "$text_secondary"},
+    }},
+    {"", ".ew-form-group", {
+        {"margin-bottom", "$spacing_md"},
+    }},
+
+    // UTILITIES
+    {"", ".ew-divider", {
+        {"border", "none"},
+        {"border-top", "1px solid $border_subtle"},
+        {"margin", "$spacing_lg 0"},
+    }},
+    {"", ".ew-spacer", {
+        {"height", "$spacing_md"},
+    }},
+    {"", ".ew-spacer-sm", {
+        {"height", "$spacing_sm"},
+    }},
+    {"", ".ew-spacer-lg", {
+        {"height", "$spacing_lg"},
+    }},
+    {"", ".ew-spacer-xl", {
+        {"height", "$spacing_xl"},
+    }},
+    {"", ".ew-link", {
+        {"color", "$text_link"},
+        {"text-decoration", "none"},
+        {"font-weight", "600"},
+        {"border-bottom", "1px solid transparent"},
+    }},
+    {"", ".ew-link:hover", {
+        {"border-bottom-color", "$text_link"},
+    }},
+    {"", ".ew-image", {
+        {"max-width", "100%"},
+        {"height", "auto"},
+    }},
+    {"", ".ew-center", {
+        {"text-align", "center"},
+    }},
+    {"", ".ew-right", {
+        {"text-align", "right"},
+    }},
+    {"", ".ew-flex-grow", {
+        {"flex-grow", "1"},
+    }},
+    {"", ".ew-flex-shrink-0", {
+        {"flex-shrink", "0"},
+    }},
+    {"", ".ew-center-content", {
+        {"justify-content", "center"},
+    }},
+    {"", ".ew-gap-sm", {
+        {"gap", "$spacing_sm"},
+    }},
+    {"", ".ew-gap-lg", {
+        {"gap", "$spacing_lg"},
+    }},
+    {"", ".ew-gap-xl", {
+        {"gap", "$spacing_xl"},
+    }},
+
+    // BADGE - Clean
+    {"", ".ew-badge", {
+        {"display", "inline-flex"},
+        {"align-items", "center"},
+        {"padding", "2px 8px"},
+        {"font-size", "$font_size_xs"},
+        {"font-weight", "500"},
+        {"border", "1px solid $border_accent"},
+        {"background", "transparent"},
+        {"color", "$text_accent"},
+    }},
+    {"", ".ew-badge-success", {
+        {"border-color", "$success"},
+        {"color", "$success"},
+    }},
+    {"", ".ew-badge-warning", {
+        {"border-color", "$warning"},
+        {"color", "$warning"},
+    }},
+    {"", ".ew-badge-error", {
+        {"border-color", "$error"},
+        {"color", "$error"},
+    }},
+
+    // STAT CARD - Clean
+    {"", ".ew-stat", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+    }},
+    {"", ".ew-stat-label", {
+        {"font-size", "$font_size_xs"},
+        {"font-weight", "500"},
+        {"color", "$text_muted"},
+        {"margin-bottom", "$spacing_xs"},
+    }},
+    {"", ".ew-stat-value", {
+        {"font-size", "$font_size_2xl"},
+        {"font-weight", "700"},
+        {"color", "$text_primary"},
+        {"line-height", "1"},
+        {"font-variant-numeric", "tabular-nums"},
+    }},
+    {"", ".ew-stat-change", {
+        {"font-size", "$font_size_sm"},
+        {"font-weight", "700"},
+        {"margin-top", "$spacing_sm"},
+    }},
+    {"", ".ew-stat-change-up", {
+        {"color", "$success"},
+    }},
+    {"", ".ew-stat-change-down", {
+        {"color", "$error"},
+    }},
+
+    // CODE BLOCK - Terminal Style
+    {"", ".ew-code", {
+        {"font-family", "'IBM Plex Mono', monospace"},
+        {"background", "$bg_card_hover"},
+        {"padding", "1px 4px"},
+        {"font-size", "$font_size_sm"},
+        {"color", "$text_accent"},
+    }},
+    {"", ".ew-code-block", {
+        {"background", "$bg_card"},
+        {"border", "1px solid $border_subtle"},
+        {"padding", "0"},
+        {"overflow", "hidden"},
+    }},
+    {"", ".ew-code-block .ew-card-title, .ew-code-block > .ew-row:first-child", {
+        {"background", "$bg_card_hover"},
+        {"border-bottom", "1px solid $border_subtle"},
+        {"padding", "$spacing_sm $spacing_md"},
+        {"margin", "0"},
+    }},
+    {"", ".ew-code-block .ew-code", {
+        {"display", "block"},
+        {"padding", "$spacing_md"},
+        {"margin", "0"},
+        {"background", "transparent"},
+        {"white-space", "pre"},
+        {"overflow-x", "auto"},
+        {"line-height", "1.5"},
+        {"color", "$text_primary"},
+    }},
+
+    // RESPONSIVE DESIGN SYSTEM
+    // Mobile-first responsive utilities
+    {"", ".ew-hidden-mobile", {
+        {"display", "none"},
+    }},
+    {"", ".ew-hidden-tablet", {
+        {"display", "initial"},
+    }},
+    {"", ".ew-hidden-desktop", {
+        {"display", "initial"},
+    }},
+    {"@media (min-width: 576px)", ".ew-hidden-mobile", {
+        {"display", "initial"},
+    }},
+    {"@media (min-width: 576px)", ".ew-hidden-tablet", {
+        {"display", "none"},
+    }},
+    {"@media (min-width: 1024px)", ".ew-hidden-tablet", {
+        {"display", "initial"},
+    }},
+    {"@media (min-width: 1024px)", ".ew-hidden-desktop", {
+        {"display", "none"},
+    }},
+    {"@media (min-width: 1200px)", ".ew-hidden-desktop", {
+        {"display", "initial"},
+    }},
+
+    // Responsive spacing utilities
+    {"", ".ew-p-sm", {
+        {"padding", "$spacing_sm"},
+    }},
+    {"", ".ew-p-md", {
+        {"padding", "$spacing_md"},
+    }},
+    {"", ".ew-p-lg", {
+        {"padding", "$spacing_lg"},
+    }},
+    {"", ".ew-p-xl", {
+        {"padding", "$spacing_xl"},
+    }},
+    {"", ".ew-m-sm", {
+        {"margin", "$spacing_sm"},
+    }},
+    {"", ".ew-m-md", {
+        {"margin", "$spacing_md"},
+    }},
+    {"", ".ew-m-lg", {
+        {"margin", "$spacing_lg"},
+    }},
+    {"", ".ew-m-xl", {
+        {"margin", "$spacing_xl"},
+    }},
+    {"", ".ew-mb-sm", {
+        {"margin-bottom", "$spacing_sm"},
+    }},
+    {"", ".ew-mb-md", {
+        {"margin-bottom", "$spacing_md"},
+    }},
+    {"", ".ew-mb-lg", {
+        {"margin-bottom", "$spacing_lg"},
+    }},
+    {"", ".ew-mb-xl", {
+        {"margin-bottom", "$spacing_xl"},
+    }},
+
+    // Responsive text sizes
+    {"", ".ew-text-xs", {
+        {"font-size", "0.75rem"},
+        {"line-height", "1rem"},
+    }},
+    {"", ".ew-text-sm", {
+        {"font-size", "0.875rem"},
+        {"line-height", "1.25rem"},
+    }},
+    {"", ".ew-text-base", {
+        {"font-size", "1rem"},
+        {"line-height", "1.5rem"},
+    }},
+    {"", ".ew-text-lg", {
+        {"font-size", "1.125rem"},
+        {"line-height", "1.75rem"},
+    }},
+    {"", ".ew-text-xl", {
+        {"font-size", "1.25rem"},
+        {"line-height", "1.75rem"},
+    }},
+    {"", ".ew-text-2xl", {
+        {"font-size", "1.5rem"},
+        {"line-height", "2rem"},
+    }},
+    {"", ".ew-text-3xl", {
+        {"font-size", "1.875rem"},
+        {"line-height", "2.25rem"},
+    }},
+
+    // Touch-friendly button sizes
+    {"", ".ew-btn-touch", {
+        {"min-height", "44px"},
+        {"min-width", "44px"},
+        {"padding", "$spacing_md"},
+    }},
+
+    // Mobile-specific utilities
+    {"", ".ew-row-mobile-stack", {
+        {"flex-direction", "row"},
+    }},
+    {"", ".ew-center-mobile", {
+        {"justify-content", "flex-start"},
+        {"text-align", "left"},
+    }},
+    {"@media (max-width: 768px)", ".ew-row-mobile-stack", {
+        {"flex-direction", "column"},
+        {"align-items", "stretch"},
+        {"gap", "$spacing_md"},
+    }},
+    {"@media (max-width: 768px)", ".ew-center-mobile", {
+        {"justify-content", "center"},
+        {"text-align", "center"},
+    }},
+
+    // Responsive grid utilities
+    {"", ".ew-grid-responsive", {
+        {"display", "grid"},
+        {"gap", "$spacing_md"},
+        {"grid-template-columns", "1fr"},
+    }},
+    {"@media (min-width: 576px)", ".ew-grid-responsive", {
+        {"grid-template-columns", "repeat(auto-fit, minmax(280px, 1fr))"},
+    }},
+    {"@media (min-width: 768px)", ".ew-grid-responsive", {
+        {"grid-template-columns", "repeat(auto-fit, minmax(320px, 1fr))"},
+    }},
+    {"@media (min-width: 1024px)", ".ew-grid-responsive", {
+        {"grid-template-columns", "repeat(auto-fit, minmax(360px, 1fr))"},
+    }},
+
+    // BREAKPOINT-SPECIFIC STYLES
+    {"@media (max-width: 1024px)", ".ew-sidebar", {
+        {"display", "none"},
+    }},
+    {"@media (max-width: 1024px)", ".ew-page", {
+        {"padding", "$spacing_md"},
+    }},
+    {"@media (max-width: 1024px)", ".ew-card", {
+        {"padding", "$spacing_md"},
+        {"margin-bottom", "$spacing_md"},
+    }},
+    {"@media (max-width: 1024px)", ".ew-card-title", {
+        {"font-size", "$font_size_base"},
+    }},
+    {"@media (max-width: 768px)", ".ew-page", {
+        {"padding", "$spacing_sm"},
+        {"max-width", "100%"},
+    }},
+    {"@media (max-width: 768px)", ".ew-grid-2, .ew-grid-3, .ew-grid-4", {
+        {"grid-template-columns", "1fr"},
+    }},
+    {"@media (max-width: 768px)", ".ew-row", {
+        {"flex-direction", "column"},
+        {"gap", "$spacing_md"},
+    }},
+    {"@media (max-width: 768px)", ".ew-navbar", {
+        {"padding", "$spacing_sm $spacing_md"},
+        {"flex-wrap", "wrap"},
+    }},
+    {"@media (max-width: 768px)", ".ew-navbar-nav", {
+        {"display", "none"},
+    }},
+    {"@media (max-width: 768px)", ".ew-navbar-brand", {
+        {"font-size", "$font_size_base"},
+    }},
+    {"@media (max-width: 768px)", ".ew-card", {
+        {"padding", "$spacing_sm"},
+        {"margin-bottom", "$spacing_md"},
+    }},
+    {"@media (max-width: 768px)", ".ew-card-title", {
+        {"font-size", "$font_size_base"},
+        {"margin-bottom", "$spacing_sm"},
+    }},
+    {"@media (max-width: 768px)", ".ew-btn", {
+        {"width", "100%"},
+        {"margin-bottom", "$spacing_sm"},
+    }},
+    {"@media (max-width: 768px)", ".ew-input, .ew-textarea", {
+        {"font-size", "16px"}, // Prevent zoom on iOS
+    }},
+    {"@media (max-width: 768px)", ".ew-chart-container", {
+        {"overflow-x", "auto"},
+        {"-webkit-overflow-scrolling", "touch"},
+    }},
+    {"@media (max-width: 768px)", ".ew-table", {
+        {"font-size", "$font_size_sm"},
+    }},
+    {"@media (max-width: 768px)", ".ew-stat-value", {
+        {"font-size", "$font_size_lg"},
+    }},
+    {"@media (max-width: 768px)", ".ew-stat-label", {
+        {"font-size", "$font_size_sm"},
+    }},
+    {"@media (max-width: 576px)", ".ew-page", {
+        {"padding", "$spacing_xs"},
+    }},
+    {"@media (max-width: 576px)", ".ew-card", {
+        {"padding", "$spacing_xs"},
+        {"border-radius", "8px"},
+    }},
+    {"@media (max-width: 576px)", ".ew-card-mobile-full", {
+        {"margin", "0 -$spacing_xs $spacing_md -$spacing_xs"},
+        {"border-radius", "0"},
+    }},
+    {"@media (max-width: 576px)", ".ew-card-title", {
+        {"font-size", "$font_size_sm"},
+        {"text-align", "center"},
+    }},
+    {"@media (max-width: 576px)", ".ew-text-h1", {
+        {"font-size", "$font_size_xl"},
+        {"text-align", "center"},
+    }},
+    {"@media (max-width: 576px)", ".ew-text-h2", {
+        {"font-size", "$font_size_lg"},
+        {"text-align", "center"},
+    }},
+    {"@media (max-width: 576px)", ".ew-text-h3", {
+        {"font-size", "$font_size_base"},
+        {"text-align", "center"},
+    }},
+    {"@media (max-width: 576px)", ".ew-spacer", {
+        {"height", "$spacing_md"},
+    }},
+    {"@media (max-width: 576px)", ".ew-spacer-sm", {
+        {"height", "$spacing_sm"},
+    }},
+    {"@media (max-width: 576px)", ".ew-spacer-lg", {
+        {"height", "$spacing_lg"},
+    }},
+    {"@media (max-width: 576px)", ".ew-spacer-xl", {
+        {"height", "$spacing_xl"},
+    }},
+
+    // Stack everything vertically on mobile
+    {"@media (max-width: 576px)", ".ew-row, .ew-row-wrap", {
+        {"flex-direction", "column"},
+        {"align-items", "stretch"},
+    }},
+    {"@media (max-width: 576px)", ".ew-center-content", {
+        {"justify-content", "center"},
+        {"text-align", "center"},
+    }},
+
+    // Make buttons more touch-friendly
+    {"@media (max-width: 576px)", ".ew-btn", {
+        {"min-height", "48px"},
+        {"font-size", "$font_size_base"},
+        {"padding", "$spacing_md $spacing_lg"},
+    }},
+
+    // Improve form elements for mobile
+    {"@media (max-width: 576px)", ".ew-input, .ew-textarea, .ew-select", {
+        {"padding", "$spacing_md"},
+        {"font-size", "16px"},
+        {"border-radius", "8px"},
+    }},
+
+    // Better spacing for lists and badges
+    {"@media (max-width: 576px)", ".ew-badge", {
+        {"font-size", "$font_size_xs"},
+        {"padding", "4px 8px"},
+    }},
+
+    // Make charts responsive
+    {"@media (max-width: 576px)", ".ew-chart-container svg", {
+        {"max-width", "100%"},
+        {"height", "auto"},
+    }},
+
+    // Chat/Streaming Components
+    {"", ".ew-chat-container", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+        {"height", "100%"},
+        {"min-height", "400px"},
+        {"max-height", "80vh"},
+        {"border", "1px solid $border_subtle"},
+        {"border-radius", "8px"},
+        {"overflow", "hidden"},
+        {"background", "$bg_card"},
+    }},
+    {"", ".ew-chat-messages", {
+        {"flex", "1"},
+        {"overflow-y", "auto"},
+        {"padding", "$spacing_lg"},
+        {"display", "flex"},
+        {"flex-direction", "column"},
+        {"gap", "$spacing_md"},
+    }},
+    {"", ".ew-chat-message", {
+        {"max-width", "80%"},
+        {"padding", "$spacing_md $spacing_lg"},
+        {"border-radius", "12px"},
+        {"line-height", "1.5"},
+    }},
+    {"", ".ew-chat-message-user", {
+        {"align-self", "flex-end"},
+        {"background", "$bg_accent"},
+        {"color", "$text_button"},
+        {"border-bottom-right-radius", "4px"},
+    }},
+    {"", ".ew-chat-message-assistant", {
+        {"align-self", "flex-start"},
+        {"background", "$bg_input"},
+        {"color", "$text_primary"},
+        {"border", "1px solid $border_subtle"},
+        {"border-bottom-left-radius", "4px"},
+    }},
+    {"", ".ew-chat-message-streaming", {
+        {"position", "relative"},
+    }},
+    {"", ".ew-chat-message-streaming::after", {
+        {"content", "'▋'"},
+        {"animation", "blink 1s infinite"},
+        {"color", "$text_accent"},
+    }},
+    {"@keyframes blink", "0%, 50%", {
+        {"opacity", "1"},
+    }},
+    {"@keyframes blink", "51%, 100%", {
+        {"opacity", "0"},
+    }},
+    {"", ".ew-chat-message-content", {
+        {"word-wrap", "break-word"},
+        {"white-space", "pre-wrap"},
+    }},
+    {"", ".ew-chat-input-container", {
+        {"display", "flex"},
+        {"gap", "$spacing_sm"},
+        {"padding", "$spacing_md"},
+        {"border-top", "1px solid $border_subtle"},
+        {"background", "$bg_card"},
+    }},
+    {"", ".ew-chat-input", {
+        {"flex", "1"},
+        {"margin", "0"},
+    }},
+    {"", ".ew-chat-stream", {
+        {"display", "flex"},
+        {"flex-direction", "column"},
+    }},
+    {"", ".ew-chat-stream-content", {
+        {"display", "inline"},
+    }},
+
+    // Streaming token styles
+    {"", ".ew-token", {
+        {"display", "inline"},
+    }},
+    {"", ".ew-token-streaming", {
+        {"border-right", "2px solid $text_accent"},
+        {"animation", "cursor-blink 1s infinite"},
+    }},
+    {"@keyframes cursor-blink", "0%, 50%", {
+        {"border-color", "$text_accent"},
+    }},
+    {"@keyframes cursor-blink", "51%, 100%", {
+        {"border-color", "transparent"},
+    }},
+
+    // Loading indicator
+    {"", ".ew-chat-loading", {
+        {"display", "flex"},
+        {"gap", "4px"},
+        {"padding", "$spacing_sm"},
+    }},
+    {"", ".ew-chat-loading-dot", {
+        {"width", "8px"},
+        {"height", "8px"},
+        {"border-radius", "50%"},
+        {"background", "$text_muted"},
+        {"animation", "loading-bounce 1.4s infinite ease-in-out both"},
+    }},
+    {"", ".ew-chat-loading-dot:nth-child(1)", {
+        {"animation-delay", "-0.32s"},
+    }},
+    {"", ".ew-chat-loading-dot:nth-child(2)", {
+        {"animation-delay", "-0.16s"},
+    }},
+    {"", ".ew-chat-loading-dot:nth-child(3)", {
+        {"animation-delay", "0"},
+    }},
+    {"@keyframes loading-bounce", "0%, 80%, 100%", {
+        {"transform", "scale(0)"},
+    }},
+    {"@keyframes loading-bounce", "40%", {
+        {"transform", "scale(1)"},
+    }},
+
+    // Mobile adjustments for chat
+    {"@media (max-width: 768px)", ".ew-chat-message", {
+        {"max-width", "90%"},
+    }},
+    {"@media (max-width: 768px)", ".ew-chat-input-container", {
+        {"flex-direction", "column"},
+    }},
+    {"@media (max-width: 768px)", ".ew-chat-input-container .ew-button", {
+        {"width", "100%"},
+    }},
+};
 
-@media (min-width: 576px) {
-    .ew-grid-responsive {
-        grid-template-columns: repeat(auto-fit, minmax(280px, 1fr));
-    }
-}
+// Every colour of a ColorScheme with its token name
+inline constexpr std::pair<std::string_view, const char* ColorScheme::*> color_scheme_fields[] =
+{
+    {"bg_page", &ColorScheme::bg_page},
+    {"bg_card", &ColorScheme::bg_card},
+    {"bg_card_hover", &ColorScheme::bg_card_hover},
+    {"bg_input", &ColorScheme::bg_input},
+    {"bg_navbar", &ColorScheme::bg_navbar},
+    {"bg_sidebar", &ColorScheme::bg_sidebar},
+    {"bg_button", &ColorScheme::bg_button},
+    {"bg_button_hover", &ColorScheme::bg_button_hover},
+    {"bg_button_secondary", &ColorScheme::bg_button_secondary},
+    {"bg_button_secondary_hover", &ColorScheme::bg_button_secondary_hover},
+    {"bg_accent", &ColorScheme::bg_accent},
+    {"text_primary", &ColorScheme::text_primary},
+    {"text_secondary", &ColorScheme::text_secondary},
+    {"text_muted", &ColorScheme::text_muted},
+    {"text_button", &ColorScheme::text_button},
+    {"text_accent", &ColorScheme::text_accent},
+    {"text_link", &ColorScheme::text_link},
+    {"border", &ColorScheme::border},
+    {"border_subtle", &ColorScheme::border_subtle},
+    {"border_focus", &ColorScheme::border_focus},
+    {"border_accent", &ColorScheme::border_accent},
+    {"shadow", &ColorScheme::shadow},
+    {"shadow_lg", &ColorScheme::shadow_lg},
+    {"success", &ColorScheme::success},
+    {"warning", &ColorScheme::warning},
+    {"error", &ColorScheme::error},
+    {"info", &ColorScheme::info}
+};
 
-@media (min-width: 768px) {
-    .ew-grid-responsive {
-        grid-template-columns: repeat(auto-fit, minmax(320px, 1fr));
+// The value of a $name token: a scheme colour or one of the Theme constants
+inline std::string_view css_token(std::string_view name, const ColorScheme& colors)
+{
+    static constexpr std::pair<std::string_view, const char*> constants[] =
+    {
+        {"font_family", Theme::font_family},
+        {"radius_none", Theme::radius_none},
+        {"radius_sm", Theme::radius_sm},
+        {"radius_md", Theme::radius_md},
+        {"radius_lg", Theme::radius_lg},
+        {"spacing_xs", Theme::spacing_xs},
+        {"spacing_sm", Theme::spacing_sm},
+        {"spacing_md", Theme::spacing_md},
+        {"spacing_lg", Theme::spacing_lg},
+        {"spacing_xl", Theme::spacing_xl},
+        {"spacing_2xl", Theme::spacing_2xl},
+        {"font_size_xs", Theme::font_size_xs},
+        {"font_size_sm", Theme::font_size_sm},
+        {"font_size_base", Theme::font_size_base},
+        {"font_size_lg", Theme::font_size_lg},
+        {"font_size_xl", Theme::font_size_xl},
+        {"font_size_2xl", Theme::font_size_2xl},
+        {"font_size_3xl", Theme::font_size_3xl}
+    };
+
+    for (const auto& [token, field] : color_scheme_fields)
+    {
+        if (token == name) return colors.*field;
     }
-}
-
-@media (min-width: 1024px) {
-    .ew-grid-responsive {
-        grid-template-columns: repeat(auto-fit, minmax(360px, 1fr));
+    for (const auto& [token, value] : constants)
+    {
+        if (token == name) return value;
     }
+    return {};
 }
 
-/* ============================================
-   BREAKPOINT-SPECIFIC STYLES
-   ============================================ */
-
-@media (max-width: 1024px) {
-    .ew-sidebar {
-        display: none;
-    }
-
-    .ew-page {
-        padding: )" + Theme::spacing_md + R"(;
-    }
-
-    .ew-card {
-        padding: )" + Theme::spacing_md + R"(;
-        margin-bottom: )" + Theme::spacing_md + R"(;
-    }
-
-    .ew-card-title {
-        font-size: )" + Theme::font_size_base + R"(;
-    }
-}
+// How write_css lays out the table
+struct CssOptions
+{
+    // The --ew-* custom properties on html; off when they are defined elsewhere
+    bool custom_properties = true;
+    // When set, only rules that can match markup using these classes (see
+    // Page::prune_css)
+    const std::unordered_set<std::string_view>* used = nullptr;
+    // No indentation or line breaks, no optional whitespace or trailing
+    // semicolons, and #aabbcc colours written as #abc
+    bool minify = false;
+    // The web font @import in front of the rules. It blocks rendering until
+    // the font CSS arrives, so sheets inlined for first paint leave it out.
+    bool font_import = true;
+};
 
-@media (max-width: 768px) {
-    .ew-page {
-        padding: )" + Theme::spacing_sm + R"(;
-        max-width: 100%;
+namespace css_detail
+{
+    inline bool is_ident(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
     }
 
-    .ew-grid-2, .ew-grid-3, .ew-grid-4 {
-        grid-template-columns: 1fr;
+    inline std::string_view trim(std::string_view s)
+    {
+        size_t b = 0, e = s.size();
+        while (b < e && (s[b] == ' ' || s[b] == '\n' || s[b] == '\t' || s[b] == '\r')) ++b;
+        while (e > b && (s[e - 1] == ' ' || s[e - 1] == '\n' || s[e - 1] == '\t' || s[e - 1] == '\r')) --e;
+        return s.substr(b, e - b);
     }
 
-    .ew-row {
-        flex-direction: column;
-        gap: )" + Theme::spacing_md + R"(;
+    // Whether name occurs in text as a whole identifier
+    inline bool contains_word(std::string_view text, std::string_view name)
+    {
+        for (size_t at = text.find(name); at != std::string_view::npos; at = text.find(name, at + 1))
+        {
+            bool starts = at == 0 || !is_ident(text[at - 1]);
+            bool ends = at + name.size() == text.size() || !is_ident(text[at + name.size()]);
+            if (starts && ends) return true;
+        }
+        return false;
     }
 
-    .ew-navbar {
-        padding: )" + Theme::spacing_sm + " " + Theme::spacing_md + R"(;
-        flex-wrap: wrap;
+    // Splits a selector list at top-level commas
+    inline std::vector<std::string_view> split_selectors(std::string_view list)
+    {
+        std::vector<std::string_view> parts;
+        int parens = 0;
+        size_t start = 0;
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (list[i] == '(') ++parens;
+            else if (list[i] == ')') --parens;
+            else if (list[i] == ',' && parens == 0)
+            {
+                parts.push_back(list.substr(start, i - start));
+                start = i + 1;
+            }
+        }
+        parts.push_back(list.substr(start));
+        return parts;
     }
 
-    .ew-navbar-nav {
-        display: none;
+    // A selector can match only if every ew-* class it requires is in use.
+    // Classes under :not(...) and other functional pseudo-classes are not
+    // requirements, and classes outside the ew- namespace are assumed to be
+    // added by scripts, so they never disqualify a selector.
+    inline bool selector_used(std::string_view selector, const std::unordered_set<std::string_view>& used)
+    {
+        int parens = 0;
+        for (size_t i = 0; i < selector.size(); ++i)
+        {
+            char c = selector[i];
+            if (c == '(') ++parens;
+            else if (c == ')') --parens;
+            else if (c == '[')
+            {
+                size_t end = selector.find(']', i);
+                if (end == std::string_view::npos) break;
+                i = end;
+            }
+            else if (c == '.' && parens == 0)
+            {
+                size_t start = i + 1, end = start;
+                while (end < selector.size() && is_ident(selector[end])) ++end;
+                std::string_view cls = selector.substr(start, end - start);
+                if (cls.compare(0, 3, "ew-") == 0 && used.find(cls) == used.end()) return false;
+                i = end - 1;
+            }
+        }
+        return true;
     }
 
-    .ew-navbar-brand {
-        font-size: )" + Theme::font_size_base + R"(;
+    inline bool is_custom_property(const CssDeclaration& d)
+    {
+        return d.property[0] == '-' && d.property[1] == '-';
     }
 
-    .ew-card {
-        padding: )" + Theme::spacing_sm + R"(;
-        margin-bottom: )" + Theme::spacing_md + R"(;
+    inline bool is_hex(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
     }
 
-    .ew-card-title {
-        font-size: )" + Theme::font_size_base + R"(;
-        margin-bottom: )" + Theme::spacing_sm + R"(;
+    // Appends a value with its $tokens resolved
+    inline void resolve(std::string& out, std::string_view value, const ColorScheme& colors)
+    {
+        size_t i = 0;
+        while (i < value.size())
+        {
+            size_t dollar = value.find('$', i);
+            if (dollar == std::string_view::npos)
+            {
+                out.append(value.substr(i));
+                break;
+            }
+            out.append(value.substr(i, dollar - i));
+            size_t end = dollar + 1;
+            while (end < value.size() && is_ident(value[end])) ++end;
+            out.append(css_token(value.substr(dollar + 1, end - dollar - 1), colors));
+            i = end;
+        }
     }
 
-    .ew-btn {
-        width: 100%;
-        margin-bottom: )" + Theme::spacing_sm + R"(;
+    // Drops whitespace next to any of the tight characters, keeps single
+    // spaces elsewhere and, in values, shortens #aabbcc to #abc
+    inline void compact(std::string& s, std::string_view tight, bool colours)
+    {
+        size_t w = 0;
+        for (size_t r = 0; r < s.size(); ++r)
+        {
+            char c = s[r];
+            if (c == ' ' || c == '\n' || c == '\t')
+            {
+                size_t next = r + 1;
+                while (next < s.size() && (s[next] == ' ' || s[next] == '\n' || s[next] == '\t')) ++next;
+                bool drop = w == 0 || next == s.size() ||
+                    tight.find(s[w - 1]) != std::string_view::npos ||
+                    tight.find(s[next]) != std::string_view::npos;
+                if (!drop) s[w++] = ' ';
+                r = next - 1;
+                continue;
+            }
+            if (colours && c == '#' && r + 7 <= s.size() &&
+                is_hex(s[r + 1]) && is_hex(s[r + 2]) && is_hex(s[r + 3]) &&
+                is_hex(s[r + 4]) && is_hex(s[r + 5]) && is_hex(s[r + 6]) &&
+                (r + 7 == s.size() || !is_ident(s[r + 7])) &&
+                s[r + 1] == s[r + 2] && s[r + 3] == s[r + 4] && s[r + 5] == s[r + 6])
+            {
+                s[w++] = '#';
+                s[w++] = s[r + 1];
+                s[w++] = s[r + 3];
+                s[w++] = s[r + 5];
+                r += 6;
+                continue;
+            }
+            s[w++] = c;
+        }
+        s.resize(w);
     }
 
-    .ew-input, .ew-textarea {
-        font-size: 16px; /* Prevent zoom on iOS */
-    }
+    // Which declarations of a rule to write
+    enum class Declarations { All, Standard, Custom };
 
-    .ew-chart-container {
-        overflow-x: auto;
-        -webkit-overflow-scrolling: touch;
+    // Writes "property: value;" lines, or "property:value" joined by ';'
+    // when minified
+    inline void write_declarations(Sink& out, const CssRule& rule, const ColorScheme& colors,
+                                   Declarations which, bool minify, std::string_view indent)
+    {
+        std::string value;
+        bool first = true;
+        for (const CssDeclaration& d : rule.declarations)
+        {
+            if (which != Declarations::All && is_custom_property(d) != (which == Declarations::Custom)) continue;
+            value.clear();
+            resolve(value, d.value, colors);
+            if (minify)
+            {
+                compact(value, ",", true);
+                if (!first) out << ';';
+                out << std::string_view(d.property) << ':' << std::string_view(value);
+            }
+            else
+            {
+                out << indent << std::string_view(d.property) << ": " << std::string_view(value) << ";\n";
+            }
+            first = false;
+        }
     }
 
-    .ew-table {
-        font-size: )" + Theme::font_size_sm + R"(;
+    // Whether a rule survives pruning; keyframes are decided separately
+    inline bool rule_used(const CssRule& rule, const std::unordered_set<std::string_view>& used)
+    {
+        for (std::string_view s : split_selectors(rule.selector))
+        {
+            if (selector_used(s, used)) return true;
+        }
+        return false;
     }
 
-    .ew-stat-value {
-        font-size: )" + Theme::font_size_lg + R"(;
+    inline bool is_keyframes(std::string_view context)
+    {
+        return context.compare(0, 10, "@keyframes") == 0;
     }
 
-    .ew-stat-label {
-        font-size: )" + Theme::font_size_sm + R"(;
+    // Whether a kept rule animates with the named keyframes
+    inline bool keyframes_used(std::string_view name, const std::vector<char>& kept)
+    {
+        for (size_t i = 0; i < kept.size(); ++i)
+        {
+            if (!kept[i]) continue;
+            for (const CssDeclaration& d : css_rules[i].declarations)
+            {
+                if (std::string_view(d.property).find("animation") != std::string_view::npos &&
+                    contains_word(d.value, name)) return true;
+            }
+        }
+        return false;
     }
 }
 
-@media (max-width: 576px) {
-    .ew-page {
-        padding: )" + Theme::spacing_xs + R"(;
-    }
-
-    .ew-card {
-        padding: )" + Theme::spacing_xs + R"(;
-        border-radius: 8px;
-    }
-
-    .ew-card-mobile-full {
-        margin: 0 -)" + Theme::spacing_xs + R"( )" + Theme::spacing_md + R"( -)" + Theme::spacing_xs + R"(;
-        border-radius: 0;
-    }
-
-    .ew-card-title {
-        font-size: )" + Theme::font_size_sm + R"(;
-        text-align: center;
-    }
-
-    .ew-text-h1 {
-        font-size: )" + Theme::font_size_xl + R"(;
-        text-align: center;
-    }
-
-    .ew-text-h2 {
-        font-size: )" + Theme::font_size_lg + R"(;
-        text-align: center;
-    }
-
-    .ew-text-h3 {
-        font-size: )" + Theme::font_size_base + R"(;
-        text-align: center;
-    }
-
-    .ew-spacer {
-        height: )" + Theme::spacing_md + R"(;
-    }
-
-    .ew-spacer-sm {
-        height: )" + Theme::spacing_sm + R"(;
-    }
-
-    .ew-spacer-lg {
-        height: )" + Theme::spacing_lg + R"(;
-    }
-
-    .ew-spacer-xl {
-        height: )" + Theme::spacing_xl + R"(;
-    }
-
-    /* Stack everything vertically on mobile */
-    .ew-row, .ew-row-wrap {
-        flex-direction: column;
-        align-items: stretch;
-    }
-
-    .ew-center-content {
-        justify-content: center;
-        text-align: center;
-    }
+// Writes the stylesheet for a colour scheme. Each rule goes out as
+// "selector {\n    property: value;\n}\n\n", nested one level inside its
+// at-rule block, or as "selector{property:value}" when minified.
+inline void write_css(Sink& out, const ColorScheme& colors, const CssOptions& options = {})
+{
+    constexpr size_t count = sizeof(css_rules) / sizeof(css_rules[0]);
 
-    /* Make buttons more touch-friendly */
-    .ew-btn {
-        min-height: 48px;
-        font-size: )" + Theme::font_size_base + R"(;
-        padding: )" + Theme::spacing_md + " " + Theme::spacing_lg + R"(;
+    // Which rules to write
+    std::vector<char> kept(count, 1);
+    if (options.used)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            kept[i] = !css_detail::is_keyframes(css_rules[i].context) && css_detail::rule_used(css_rules[i], *options.used);
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string_view context = css_rules[i].context;
+            if (!css_detail::is_keyframes(context)) continue;
+            bool used = css_detail::keyframes_used(css_detail::trim(context.substr(10)), kept);
+            for (; i < count && context == css_rules[i].context; ++i) kept[i] = used;
+            --i;
+        }
     }
 
-    /* Improve form elements for mobile */
-    .ew-input, .ew-textarea, .ew-select {
-        padding: )" + Theme::spacing_md + R"(;
-        font-size: 16px;
-        border-radius: 8px;
+    const bool minify = options.minify;
+    if (options.font_import)
+    {
+        out << "@import url('https://fonts.googleapis.com/css2?family=IBM+Plex+Mono:wght@400;500;600;700&display=swap');";
+        if (!minify) out << "\n\n";
     }
 
-    /* Better spacing for lists and badges */
-    .ew-badge {
-        font-size: )" + Theme::font_size_xs + R"(;
-        padding: 4px 8px;
-    }
+    std::string_view open;
+    std::string text;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!kept[i]) continue;
+        const CssRule& rule = css_rules[i];
+        std::string_view context = rule.context;
+        if (context != open)
+        {
+            if (!open.empty()) out << (minify ? "}" : "}\n\n");
+            if (!context.empty())
+            {
+                text.assign(context);
+                if (minify) css_detail::compact(text, ",:", false);
+                out << std::string_view(text) << (minify ? "{" : " {\n");
+            }
+            open = context;
+        }
+        std::string_view indent = minify || open.empty() ? "" : "    ";
 
-    /* Make charts responsive */
-    .ew-chart-container svg {
-        max-width: 100%;
-        height: auto;
+        text.clear();
+        if (options.used)
+        {
+            // Only the selectors in use
+            for (std::string_view s : css_detail::split_selectors(rule.selector))
+            {
+                if (!css_detail::selector_used(s, *options.used)) continue;
+                if (!text.empty()) text += ", ";
+                text += css_detail::trim(s);
+            }
+        }
+        else
+        {
+            text = rule.selector;
+        }
+        if (minify) css_detail::compact(text, ",>+~", false);
+
+        out << indent << std::string_view(text) << (minify ? "{" : " {\n");
+        css_detail::write_declarations(out, rule, colors,
+            options.custom_properties ? css_detail::Declarations::All : css_detail::Declarations::Standard,
+            minify, open.empty() ? "    " : "        ");
+        if (minify) out << '}';
+        else out << indent << (open.empty() ? "}\n\n" : "}\n");
     }
+    if (!open.empty()) out << (minify ? "}" : "}\n\n");
 }
 
-/* ============================================================================
-   Chat/Streaming Components
-   ============================================================================ */
-
-.ew-chat-container {
-    display: flex;
-    flex-direction: column;
-    height: 100%;
-    min-height: 400px;
-    max-height: 80vh;
-    border: 1px solid )" + std::string(colors.border_subtle) + R"(;
-    border-radius: 8px;
-    overflow: hidden;
-    background: )" + std::string(colors.bg_card) + R"(;
-}
-
-.ew-chat-messages {
-    flex: 1;
-    overflow-y: auto;
-    padding: )" + Theme::spacing_lg + R"(;
-    display: flex;
-    flex-direction: column;
-    gap: )" + Theme::spacing_md + R"(;
-}
-
-.ew-chat-message {
-    max-width: 80%;
-    padding: )" + Theme::spacing_md + R"( )" + Theme::spacing_lg + R"(;
-    border-radius: 12px;
-    line-height: 1.5;
-}
-
-.ew-chat-message-user {
-    align-self: flex-end;
-    background: )" + std::string(colors.bg_accent) + R"(;
-    color: )" + std::string(colors.text_button) + R"(;
-    border-bottom-right-radius: 4px;
-}
-
-.ew-chat-message-assistant {
-    align-self: flex-start;
-    background: )" + std::string(colors.bg_input) + R"(;
-    color: )" + std::string(colors.text_primary) + R"(;
-    border: 1px solid )" + std::string(colors.border_subtle) + R"(;
-    border-bottom-left-radius: 4px;
-}
-
-.ew-chat-message-streaming {
-    position: relative;
-}
-
-.ew-chat-message-streaming::after {
-    content: '▋';
-    animation: blink 1s infinite;
-    color: )" + std::string(colors.text_accent) + R"(;
-}
-
-@keyframes blink {
-    0%, 50% { opacity: 1; }
-    51%, 100% { opacity: 0; }
-}
-
-.ew-chat-message-content {
-    word-wrap: break-word;
-    white-space: pre-wrap;
-}
-
-.ew-chat-input-container {
-    display: flex;
-    gap: )" + Theme::spacing_sm + R"(;
-    padding: )" + Theme::spacing_md + R"(;
-    border-top: 1px solid )" + std::string(colors.border_subtle) + R"(;
-    background: )" + std::string(colors.bg_card) + R"(;
-}
-
-.ew-chat-input {
-    flex: 1;
-    margin: 0;
-}
-
-.ew-chat-stream {
-    display: flex;
-    flex-direction: column;
-}
-
-.ew-chat-stream-content {
-    display: inline;
-}
-
-/* Streaming token styles */
-.ew-token {
-    display: inline;
+// Classes whose rules are needed for the first paint: page layout, navbar,
+// sidebar, cards and typography. The rest of the stylesheet can arrive later.
+inline bool is_critical_class(std::string_view cls)
+{
+    static constexpr std::string_view prefixes[] =
+    {
+        "ew-app", "ew-main", "ew-page", "ew-navbar", "ew-sidebar", "ew-card",
+        "ew-row", "ew-column", "ew-grid", "ew-box", "ew-center", "ew-right",
+        "ew-gap", "ew-spacer", "ew-m", "ew-mb", "ew-p", "ew-hidden", "ew-flex",
+        "ew-text", "ew-heading"
+    };
+    for (std::string_view prefix : prefixes)
+    {
+        if (cls.compare(0, prefix.size(), prefix) == 0 &&
+            (cls.size() == prefix.size() || cls[prefix.size()] == '-')) return true;
+    }
+    return false;
 }
 
-.ew-token-streaming {
-    border-right: 2px solid )" + std::string(colors.text_accent) + R"(;
-    animation: cursor-blink 1s infinite;
+// Runs write_css into a string sized by a measuring pass first
+inline std::string generate_css(const ColorScheme& colors, const CssOptions& options)
+{
+    CountingSink size;
+    write_css(size, colors, options);
+    std::string css;
+    css.reserve(size.size());
+    StringSink out(css);
+    write_css(out, colors, options);
+    return css;
 }
 
-@keyframes cursor-blink {
-    0%, 50% { border-color: )" + std::string(colors.text_accent) + R"(; }
-    51%, 100% { border-color: transparent; }
+// The --ew-* custom property declarations for a colour scheme
+inline std::string theme_variables(const ColorScheme& colors, bool minify = false)
+{
+    std::string css;
+    StringSink out(css);
+    for (const CssRule& rule : css_rules)
+    {
+        if (std::string_view(rule.selector) == "html")
+        {
+            css_detail::write_declarations(out, rule, colors, css_detail::Declarations::Custom, minify, "    ");
+        }
+    }
+    return css;
 }
 
-/* Loading indicator */
-.ew-chat-loading {
-    display: flex;
-    gap: 4px;
-    padding: )" + Theme::spacing_sm + R"(;
+// The stylesheet with a scheme's colours spliced into every rule. Without
+// with_variables the --ew-* declarations on html are left out, for callers
+// that define them elsewhere.
+inline std::string generate_css(const ColorScheme& colors, bool with_variables)
+{
+    CssOptions options;
+    options.custom_properties = with_variables;
+    return generate_css(colors, options);
 }
 
-.ew-chat-loading-dot {
-    width: 8px;
-    height: 8px;
-    border-radius: 50%;
-    background: )" + std::string(colors.text_muted) + R"(;
-    animation: loading-bounce 1.4s infinite ease-in-out both;
+// Lower-case name of a built-in theme, as used in asset file names
+inline const char* theme_name(ThemeMode mode)
+{
+    switch (mode)
+    {
+        case ThemeMode::Light: return "light";
+        case ThemeMode::Cream: return "cream";
+        case ThemeMode::Dark: break;
+    }
+    return "dark";
 }
 
-.ew-chat-loading-dot:nth-child(1) { animation-delay: -0.32s; }
-.ew-chat-loading-dot:nth-child(2) { animation-delay: -0.16s; }
-.ew-chat-loading-dot:nth-child(3) { animation-delay: 0; }
-
-@keyframes loading-bounce {
-    0%, 80%, 100% { transform: scale(0); }
-    40% { transform: scale(1); }
+inline std::string generate_css(const Theme& theme = Theme{})
+{
+    return generate_css(theme.get_colors(), true);
 }
 
-/* Mobile adjustments for chat */
-@media (max-width: 768px) {
-    .ew-chat-message {
-        max-width: 90%;
+// One stylesheet for every built-in theme: the rules once, written against
+// the --ew-* custom properties, then a block of property values per theme
+// selected by the data-theme attribute on <html>. Without the attribute the
+// page is dark. The rules are pruned and minified as options say; the
+// property blocks are always kept.
+inline std::string generate_all_themes_css(const CssOptions& options = {})
+{
+    CssOptions rules = options;
+    rules.custom_properties = false;
+    std::string css = generate_css(Theme::variable_colors, rules);
+    const ThemeMode modes[] = {ThemeMode::Dark, ThemeMode::Light, ThemeMode::Cream};
+    for (ThemeMode mode : modes)
+    {
+        Theme theme;
+        theme.mode = mode;
+        if (options.minify)
+        {
+            css += mode == ThemeMode::Dark ? ":root,[data-theme=\"" : "[data-theme=\"";
+            css += theme_name(mode);
+            css += "\"]{" + theme_variables(theme.get_colors(), true) + "}";
+            continue;
+        }
+        css += mode == ThemeMode::Dark ? ":root, [data-theme=\"" : "\n[data-theme=\"";
+        css += theme_name(mode);
+        css += "\"] {\n";
+        css += theme_variables(theme.get_colors());
+        css += "}\n";
     }
+    return css;
+}
 
-    .ew-chat-input-container {
-        flex-direction: column;
+namespace css_detail
+{
+    template<bool Minify, bool FontImport>
+    std::string_view cached_all_themes_css()
+    {
+        CssOptions options;
+        options.minify = Minify;
+        options.font_import = FontImport;
+        static const std::string css = generate_all_themes_css(options);
+        return css;
     }
+}
 
-    .ew-chat-input-container .ew-button {
-        width: 100%;
+// generate_all_themes_css(), generated on first use and kept
+inline std::string_view cached_all_themes_css(bool minified = false, bool font_import = true)
+{
+    if (font_import)
+    {
+        return minified ? css_detail::cached_all_themes_css<true, true>() : css_detail::cached_all_themes_css<false, true>();
     }
-}
-)";
+    return minified ? css_detail::cached_all_themes_css<true, false>() : css_detail::cached_all_themes_css<false, false>();
 }
 
 }
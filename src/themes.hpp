@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "styles.hpp"
+#include "assets.hpp"
+
+namespace zero_js
+{
+
+// ============================================================================
+// Theme Registry
+// ============================================================================
+
+// A registered colour scheme. The colour strings are owned by the entry, and
+// its stylesheets (full or minified, with or without the web font import)
+// are generated on first use and kept.
+// Entries never move once registered.
+class ThemeEntry {
+public:
+    ThemeEntry(std::string name, const ColorScheme& source) : name_(std::move(name)) {
+        for (size_t i = 0; i < values_.size(); ++i) {
+            auto field = color_scheme_fields[i].second;
+            values_[i] = source.*field;
+            colors_.*field = values_[i].c_str();
+        }
+    }
+
+    ThemeEntry(const ThemeEntry&) = delete;
+    ThemeEntry& operator=(const ThemeEntry&) = delete;
+
+    const std::string& name() const { return name_; }
+    const ColorScheme& colors() const { return colors_; }
+
+    // The stylesheet as zero_js-<name>.<hash>.css. Thread-safe.
+    const Asset& stylesheet(bool minified, bool font_import = true) const {
+        Sheet& sheet = sheets_[minified ? 1 : 0][font_import ? 1 : 0];
+        std::call_once(sheet.once, [&] {
+            CssOptions options;
+            options.minify = minified;
+            options.font_import = font_import;
+            sheet.asset = make_asset("zero_js-" + name_, "css", generate_css(colors_, options));
+        });
+        return sheet.asset;
+    }
+
+private:
+    struct Sheet {
+        std::once_flag once;
+        Asset asset;
+    };
+
+    std::string name_;
+    std::array<std::string, std::size(color_scheme_fields)> values_;
+    ColorScheme colors_{};
+    mutable Sheet sheets_[2][2];
+};
+
+// Cheap, copyable reference to a registered theme; stylesheet lookups through
+// it take no lock. A default-constructed handle is the built-in dark theme.
+class ThemeHandle {
+public:
+    ThemeHandle();
+
+    const std::string& name() const { return entry_->name(); }
+    const ColorScheme& colors() const { return entry_->colors(); }
+    std::string_view css(bool minified = false, bool font_import = true) const {
+        return *entry_->stylesheet(minified, font_import).content;
+    }
+    const Asset& stylesheet(bool minified = false, bool font_import = true) const {
+        return entry_->stylesheet(minified, font_import);
+    }
+
+    bool operator==(const ThemeHandle& other) const { return entry_ == other.entry_; }
+    bool operator!=(const ThemeHandle& other) const { return entry_ != other.entry_; }
+
+private:
+    friend class ThemeRegistry;
+    explicit ThemeHandle(const ThemeEntry* entry) : entry_(entry) {}
+
+    const ThemeEntry* entry_;
+};
+
+// Named colour schemes, registered at run time. The built-in dark, light and
+// cream themes are always there. Registering and looking up by name lock;
+// handles stay valid for the registry's lifetime.
+class ThemeRegistry {
+public:
+    ThemeRegistry() {
+        entries_.emplace_back("dark", Theme::dark_colors);
+        entries_.emplace_back("light", Theme::light_colors);
+        entries_.emplace_back("cream", Theme::cream_colors);
+        for (size_t i = 0; i < 3; ++i) builtins_[i] = &entries_[i];
+    }
+
+    ThemeRegistry(const ThemeRegistry&) = delete;
+    ThemeRegistry& operator=(const ThemeRegistry&) = delete;
+
+    // Copies the scheme's colours. The name is used in stylesheet file
+    // names, so keep it to letters, digits and dashes. A name can only be
+    // registered once: adding it again returns the first registration.
+    ThemeHandle add(const std::string& name, const ColorScheme& colors) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const ThemeEntry& entry : entries_) {
+            if (entry.name() == name) return ThemeHandle(&entry);
+        }
+        entries_.emplace_back(name, colors);
+        return ThemeHandle(&entries_.back());
+    }
+
+    std::optional<ThemeHandle> find(std::string_view name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const ThemeEntry& entry : entries_) {
+            if (entry.name() == name) return ThemeHandle(&entry);
+        }
+        return std::nullopt;
+    }
+
+    // Set up by the constructor and never changed, so no lock is needed
+    ThemeHandle builtin(ThemeMode mode) const {
+        switch (mode) {
+            case ThemeMode::Light: return ThemeHandle(builtins_[1]);
+            case ThemeMode::Cream: return ThemeHandle(builtins_[2]);
+            case ThemeMode::Dark: break;
+        }
+        return ThemeHandle(builtins_[0]);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // The registry pages use
+    static ThemeRegistry& global() {
+        static ThemeRegistry registry;
+        return registry;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<ThemeEntry> entries_;
+    const ThemeEntry* builtins_[3];
+};
+
+inline ThemeHandle::ThemeHandle() : entry_(ThemeRegistry::global().builtin(ThemeMode::Dark).entry_) {}
+
+// The stylesheet for a built-in theme, as written out or minified, generated
+// on first use and kept for the life of the process. Thread-safe; the view
+// never dangles.
+inline std::string_view cached_css(ThemeMode mode, bool minified = false) {
+    return ThemeRegistry::global().builtin(mode).css(minified);
+}
+
+// The full stylesheet of a built-in theme as zero_js-<theme>.<hash>.css,
+// built once per process
+inline const Asset& stylesheet_asset(ThemeMode mode, bool minified = false) {
+    return ThemeRegistry::global().builtin(mode).stylesheet(minified);
+}
+
+}
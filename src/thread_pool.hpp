@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zero_js
+{
+
+// ============================================================================
+// Work-Stealing Thread Pool
+// ============================================================================
+
+// Each worker owns a deque. Tasks submitted from a worker go to its own deque
+// and are taken newest-first (good locality for nested fan-out); idle workers
+// steal the oldest task from another deque. Threads that wait on a TaskGroup
+// run pending tasks instead of blocking, so nested waits cannot deadlock.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    void submit(std::function<void()> task) {
+        size_t index = current_pool() == this
+            ? current_index()
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            ++pending_;
+        }
+        wake_.notify_one();
+    }
+
+    // Runs one pending task on the calling thread, if there is one
+    bool run_one() {
+        std::function<void()> task;
+        size_t home = current_pool() == this ? current_index() : 0;
+        if (!take(home, task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static ThreadPool*& current_pool() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& current_index() {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    // Own deque from the back, then steal from the front of the others
+    bool take(size_t home, std::function<void()>& task) {
+        {
+            Queue& own = *queues_[home];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                claimed();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            Queue& victim = *queues_[(home + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                claimed();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void claimed() {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        --pending_;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool() = this;
+        current_index() = index;
+        std::function<void()> task;
+        for (;;) {
+            if (take(index, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this] { return stop_ || pending_ > 0; });
+            if (stop_ && pending_ == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    size_t pending_ = 0;
+    bool stop_ = false;
+};
+
+// Pool shared by everything that does not bring its own
+inline ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// A batch of tasks to wait for. wait() helps run queued work while the batch
+// is unfinished, and rethrows the first exception a task threw.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+    ~TaskGroup() { wait_quietly(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task) {
+        remaining_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit([this, task = std::move(task)] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            // Decrement under the lock: the waiter takes it before returning,
+            // so the group outlives this block
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                done_.notify_all();
+            }
+        });
+    }
+
+    void wait() {
+        wait_quietly();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void wait_quietly() {
+        while (remaining_.load(std::memory_order_acquire) > 0) {
+            if (pool_.run_one()) continue;
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait_for(lock, std::chrono::microseconds(200), [this] {
+                return remaining_.load(std::memory_order_acquire) == 0;
+            });
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+    ThreadPool& pool_;
+    std::atomic<size_t> remaining_{0};
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
+
+}
@@ -0,0 +1,148 @@
+// Unit tests for font subsetting
+// Build: g++ -std=c++17 -I.. fonts_test.cpp -o fonts_test
+
+#define ATTEST_IMPLEMENTATION
+#include "attest.h"
+#include "../zero_js.hpp"
+
+using namespace zero_js;
+using namespace zero_js::font_detail;
+
+// Glyph ids in the test font
+enum : uint16_t { notdef, glyph_f, glyph_i, glyph_fi, glyph_x, glyph_count };
+
+// A TrueType font with empty outlines for .notdef, f, i, an f+i ligature
+// and x, with a GSUB table that substitutes the ligature for f followed by i
+static std::string test_font()
+{
+    std::string glyf, loca;
+    for (uint16_t g = 0; g < glyph_count; ++g)
+    {
+        put32(loca, uint32_t(glyf.size()));
+        glyf.append(12, '\0');   // no contours, zero bounding box, no instructions
+    }
+    put32(loca, uint32_t(glyf.size()));
+
+    std::string head(54, '\0');
+    set32(head, 0, 0x00010000);
+    set32(head, 12, 0x5F0F3CF5);   // magic number
+    head[51] = 1;                   // long loca offsets
+
+    std::string maxp;
+    put32(maxp, 0x00005000);
+    put16(maxp, glyph_count);
+
+    // Unicode cmap, format 4: one segment per character and the final 0xFFFF
+    const uint16_t chars[] = {'f', 'i', 'x', 0xFFFF};
+    const uint16_t glyphs[] = {glyph_f, glyph_i, glyph_x, 0};
+    std::string format4;
+    put16(format4, 4);
+    put16(format4, 16 + 4 * 8);
+    put16(format4, 0);
+    put16(format4, 8);
+    put16(format4, 8);
+    put16(format4, 2);
+    put16(format4, 0);
+    for (uint16_t c : chars) put16(format4, c);
+    put16(format4, 0);
+    for (uint16_t c : chars) put16(format4, c);
+    for (size_t s = 0; s < 4; ++s) put16(format4, uint16_t(chars[s] == 0xFFFF ? 1 : glyphs[s] - chars[s]));
+    for (size_t s = 0; s < 4; ++s) put16(format4, 0);
+    std::string cmap;
+    put16(cmap, 0);
+    put16(cmap, 1);
+    put16(cmap, 3);
+    put16(cmap, 1);
+    put32(cmap, 12);
+    cmap += format4;
+
+    // GSUB with empty script and feature lists and one ligature lookup
+    std::string gsub;
+    put32(gsub, 0x00010000);
+    put16(gsub, 10);   // ScriptList
+    put16(gsub, 12);   // FeatureList
+    put16(gsub, 14);   // LookupList
+    put16(gsub, 0);
+    put16(gsub, 0);
+    put16(gsub, 1);    // LookupList: one lookup, at 4
+    put16(gsub, 4);
+    put16(gsub, 4);    // Lookup: ligature substitution, one subtable, at 8
+    put16(gsub, 0);
+    put16(gsub, 1);
+    put16(gsub, 8);
+    put16(gsub, 1);    // Subtable: coverage at 18, one ligature set, at 8
+    put16(gsub, 18);
+    put16(gsub, 1);
+    put16(gsub, 8);
+    put16(gsub, 1);    // LigatureSet: one ligature, at 4
+    put16(gsub, 4);
+    put16(gsub, glyph_fi);   // Ligature: fi from f (covered) and i
+    put16(gsub, 2);
+    put16(gsub, glyph_i);
+    put16(gsub, 1);    // Coverage: f
+    put16(gsub, 1);
+    put16(gsub, glyph_f);
+
+    const std::pair<uint32_t, const std::string*> tables[] = {
+        {tag("GSUB"), &gsub}, {tag("cmap"), &cmap}, {tag("glyf"), &glyf},
+        {tag("head"), &head}, {tag("loca"), &loca}, {tag("maxp"), &maxp},
+    };
+    std::string font;
+    put32(font, 0x00010000);
+    put16(font, 6);
+    put16(font, 64);
+    put16(font, 2);
+    put16(font, 32);
+    size_t offset = 12 + 6 * 16;
+    for (const auto& [name, data] : tables)
+    {
+        put32(font, name);
+        put32(font, checksum(*data));
+        put32(font, uint32_t(offset));
+        put32(font, uint32_t(data->size()));
+        offset += (data->size() + 3) & ~size_t(3);
+    }
+    for (const auto& table : tables)
+    {
+        font += *table.second;
+        font.resize((font.size() + 3) & ~size_t(3), '\0');
+    }
+    return font;
+}
+
+// Outline length of a glyph in a subset font, or -1 if it cannot be read
+static long glyph_length(std::string_view font, uint16_t glyph)
+{
+    std::vector<Table> tables;
+    if (!read_tables(font, tables)) return -1;
+    std::string_view loca = find_table(tables, tag("loca"));
+    if ((size_t(glyph) + 2) * 4 > loca.size()) return -1;
+    return long(u32(loca, (size_t(glyph) + 1) * 4)) - long(u32(loca, size_t(glyph) * 4));
+}
+
+static std::string subset_of(std::string_view text)
+{
+    std::set<char32_t> codepoints;
+    add_codepoints(text, codepoints);
+    return subset_ttf(test_font(), codepoints);
+}
+
+REGISTER_TEST(subset_keeps_mapped_glyphs)
+{
+    std::string subset = subset_of("f");
+    ATTEST_EQUAL(glyph_length(subset, notdef), 12L);
+    ATTEST_EQUAL(glyph_length(subset, glyph_f), 12L);
+    ATTEST_EQUAL(glyph_length(subset, glyph_x), 0L);
+}
+
+REGISTER_TEST(subset_keeps_ligature_of_kept_glyphs)
+{
+    std::string subset = subset_of("office");
+    ATTEST_EQUAL(glyph_length(subset, glyph_fi), 12L);
+}
+
+REGISTER_TEST(subset_drops_ligature_missing_a_component)
+{
+    std::string subset = subset_of("fox");
+    ATTEST_EQUAL(glyph_length(subset, glyph_fi), 0L);
+}
@@ -1,34 +1,429 @@
 #pragma once
 
+#include "src/sink.hpp"
 #include "src/styles.hpp"
+#include "src/themes.hpp"
 #include "src/htmx.hpp"
 #include "src/renderer.hpp"
 #include "src/components.hpp"
 #include "src/charts.hpp"
+#include "src/scan.hpp"
+#include "src/output.hpp"
+#include "src/compress.hpp"
+#include "src/assets.hpp"
+#include "src/manifest.hpp"
+#include "src/fonts.hpp"
+#include "src/site.hpp"
 
 //include this header in your project
 
 namespace zero_js
 {
+    // The full stylesheet before any pruning
+    inline std::string_view Page::base_css() const
+    {
+    return all_themes_ ? cached_all_themes_css(minified(), fonts_.empty()) : theme_.css(minified(), fonts_.empty());
+    }
+
+    // File name stem of this page's stylesheet asset
+    inline std::string Page::css_stem() const
+    {
+    return all_themes_ ? std::string("zero_js-themes") : "zero_js-" + theme_.name();
+    }
+
+    inline std::string Page::render_body() const
+    {
+    std::string body;
+    StringSink body_out(body);
+    ParallelRenderScope scope(parallel_.pool ? &parallel_ : nullptr);
+    render_children(children_, body_out);
+    return body;
+    }
+
+    // Classes in the rendered body and the kept ones. The views point into
+    // body and keep_classes_.
+    inline std::unordered_set<std::string_view> Page::used_classes(const std::string& body) const
+    {
+    std::unordered_set<std::string_view> used;
+    collect_classes(body, used);
+    add_class_list(keep_classes_, used);
+    return used;
+    }
+
+    // The theme's rules that can match the rendered body or a kept class
+    inline std::string Page::used_css(const std::string& body) const
+    {
+    std::unordered_set<std::string_view> used = used_classes(body);
+    CssOptions options;
+    options.used = &used;
+    options.minify = minified();
+    options.font_import = fonts_.empty();
+    return all_themes_ ? generate_all_themes_css(options) : generate_css(theme_.colors(), options);
+    }
+
+    // The used rules of the critical classes only, without the font import
+    inline std::string Page::first_paint_css(const std::string& body) const
+    {
+    std::unordered_set<std::string_view> critical;
+    for (std::string_view cls : used_classes(body))
+    {
+        if (is_critical_class(cls)) critical.insert(cls);
+    }
+    CssOptions options;
+    options.used = &critical;
+    options.minify = minified();
+    options.font_import = false;
+    return all_themes_ ? generate_all_themes_css(options) : generate_css(theme_.colors(), options);
+    }
+
+    // The characters of the rendered body, the font_text() and generated
+    // content in the stylesheet
+    inline void Page::add_font_characters(const std::string& body, std::set<char32_t>& codepoints) const
+    {
+    collect_codepoints(body, codepoints);
+    add_codepoints(font_text_, codepoints);
+    for (const CssRule& rule : css_rules)
+    {
+        for (const CssDeclaration& d : rule.declarations)
+        {
+            if (std::string_view(d.property) == "content") add_codepoints(d.value, codepoints);
+        }
+    }
+    }
+
+    inline bool Page::font_characters(std::set<char32_t>& codepoints) const
+    {
+    if (fonts_.empty()) return false;
+    add_font_characters(render_body(), codepoints);
+    return true;
+    }
+
+    // Subsets the self-hosted fonts to the page's characters, or to those of
+    // the current FontCharactersScope
+    inline void Page::subset_fonts(Prepared& p) const
+    {
+    std::set<char32_t> own;
+    const std::set<char32_t>* shared = current_font_characters();
+    if (!shared) add_font_characters(p.body, own);
+    const std::set<char32_t>& codepoints = shared ? *shared : own;
+
+    // The first family of the theme's font stack
+    std::string_view family = Theme::font_family;
+    family = family.substr(0, family.find(','));
+    for (const FontFile& font : fonts_)
+    {
+        Asset asset = font_asset(font, codepoints);
+        if (!asset.content) continue;
+        p.font_css += font_face_css(family, css_href_prefix_ + asset.name, font, codepoints, minified());
+        p.fonts.push_back(std::move(asset));
+    }
+    }
+
+    // Walks the tree (without rendering it) for hx-* and sse-* use, unless
+    // auto_scripts() is off
+    inline ScriptNeeds Page::needed_scripts() const
+    {
+    ScriptNeeds needs;
+    if (!include_htmx_) return needs;
+    if (detect_scripts_)
+    {
+        std::function<void(const Component&)> walk = [&needs, &walk](const Component& node) {
+            ScriptNeeds own = node.scripts_needed();
+            needs.htmx |= own.htmx;
+            needs.sse |= own.sse;
+            if (!needs.sse) node.for_each_child(walk);
+        };
+        for_each_child(walk);
+    }
+    else
+    {
+        needs.htmx = true;
+    }
+    if (include_sse_) needs.htmx = needs.sse = true;
+    return needs;
+    }
+
+    // Renders the body up front when CSS pruning or font subsetting needs
+    // it (or the caller asks), then settles which stylesheet and fonts this
+    // render inlines or links
+    inline void Page::prepare(Prepared& p, bool body_first) const
+    {
+    if (body_first || prune_css_ || critical_css_ || !fonts_.empty())
+    {
+        p.body = render_body();
+        p.has_body = true;
+    }
+    p.css = base_css();
+    if (prune_css_)
+    {
+        p.pruned_css = used_css(p.body);
+        p.css = p.pruned_css;
+    }
+    if (external_css_ || critical_css_)
+    {
+        p.href = css_href_prefix_ + (prune_css_ ? asset_name(css_stem(), "css", p.css) : stylesheet().name);
+    }
+    if (critical_css_)
+    {
+        p.critical_css = first_paint_css(p.body);
+    }
+    if (!fonts_.empty())
+    {
+        subset_fonts(p);
+    }
+    p.scripts = needed_scripts();
+    if (scripts_ == ScriptSource::External)
+    {
+        p.htmx_src = script_href_prefix_ + htmx_asset().name;
+        p.sse_src = script_href_prefix_ + htmx_sse_asset().name;
+    }
+    else if (scripts_ == ScriptSource::Cdn)
+    {
+        p.htmx_src = htmx_cdn_url;
+        p.sse_src = htmx_sse_cdn_url;
+    }
+    }
+
+    inline PageHead Page::head(const Prepared& p) const
+    {
+    PageHead h;
+    h.title = title_;
+    h.css = critical_css_ ? std::string_view(p.critical_css) : p.css;
+    h.stylesheet_href = p.href;
+    h.defer_stylesheet = critical_css_;
+    h.font_css = p.font_css;
+    if (all_themes_) h.data_theme = theme_.name();
+    h.include_htmx = p.scripts.htmx;
+    h.include_sse = p.scripts.sse;
+    h.compact = compact_;
+    h.htmx_src = p.htmx_src;
+    h.sse_src = p.sse_src;
+    return h;
+    }
+
+    // p must outlive the sink's flush: its body and CSS are referenced
+    inline void Page::render_document(Sink& out, const Prepared& p) const
+    {
+    render_page_open(out, head(p));
+    if (p.has_body)
+    {
+        out << p.body;
+    }
+    else
+    {
+        ParallelRenderScope scope(parallel_.pool ? &parallel_ : nullptr);
+        render_children(children_, out);
+    }
+    render_page_close(out, compact_);
+    }
+
+    inline Asset Page::stylesheet() const
+    {
+    if (prune_css_)
+    {
+        return make_asset(css_stem(), "css", used_css(render_body()));
+    }
+    return all_themes_ ? all_themes_stylesheet_asset(minified(), fonts_.empty()) : theme_.stylesheet(minified(), fonts_.empty());
+    }
+
+    inline std::vector<Asset> Page::fonts() const
+    {
+    if (fonts_.empty()) return {};
+    Prepared p;
+    prepare(p, true);
+    return std::move(p.fonts);
+    }
+
+    inline std::vector<Asset> Page::scripts() const
+    {
+    std::vector<Asset> scripts;
+    ScriptNeeds needs = needed_scripts();
+    if (scripts_ != ScriptSource::External || !needs.htmx) return scripts;
+    scripts.push_back(htmx_asset());
+    if (needs.sse) scripts.push_back(htmx_sse_asset());
+    return scripts;
+    }
+
+    inline void Page::render_to(Sink& out) const
+    {
+    if (prune_css_ || critical_css_ || !fonts_.empty())
+    {
+        // The body and generated CSS would be locals here, so hand the sink a copy
+        out << render();
+        return;
+    }
+    Prepared p;
+    prepare(p, false);
+    render_document(out, p);
+    }
+
+    // Sizes the buffer from the head and close, which cost next to nothing
+    // to count since the stylesheet and scripts are views, plus the body if
+    // it is already rendered or a fixed allowance if not. With exact_size()
+    // the whole document is measured first instead. In parallel mode the
+    // body is rendered once up front, since a parallel render already
+    // buffers every child.
     inline std::string Page::render() const
     {
+    Prepared p;
+    prepare(p, parallel_.pool != nullptr);
+
+    CountingSink size;
+    size_t allowance = 0;
+    if (exact_size_ || p.has_body)
+    {
+        render_document(size, p);
+    }
+    else
+    {
+        render_page_open(size, head(p));
+        render_page_close(size, compact_);
+        allowance = body_allowance;
+    }
+
+    std::string html;
+    html.reserve(size.size() + allowance);
+    StringSink out(html);
+    render_document(out, p);
+    return html;
+    }
+
+    inline bool Page::render_to_fd(int fd) const
+    {
+    Prepared p;
+    prepare(p, false);
+    SegmentSink out;
+    render_document(out, p);
+    return out.flush(fd);
+    }
+
+    inline WriteResult Page::write_files(const std::string& path, const WriteOptions& options) const
+    {
+        Prepared p;
+        prepare(p, false);
+
+        WriteResult result;
+        auto note = [&result](const WriteResult& r) {
+            if (result && !r) result = r;
+        };
+
+        // A relative href prefix is a directory next to the page, created if
+        // missing. Returns false (and leaves dir alone) for absolute paths
+        // and URLs, and when the directory cannot be created.
+        auto asset_dir = [&path, &note](const std::string& prefix, std::string& dir) {
+            if (!prefix.empty() && (prefix[0] == '/' || prefix.find("://") != std::string::npos)) return false;
+            size_t slash = path.rfind('/');
+            dir = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+            dir += prefix;
+            while (!dir.empty() && dir.back() == '/') dir.pop_back();
+            WriteResult made = dir.empty() ? WriteResult() : output_detail::make_dir(dir);
+            note(made);
+            return static_cast<bool>(made);
+        };
 
-    ThemeMode mode = ThemeMode::Dark;
-    if (theme_mode_ == 1)
+        // Assets go first, so the page never links a file that is not there
+        // yet; if one fails, the page is not written
+        std::string dir;
+        bool linked_css = external_css_ || critical_css_;
+        if ((linked_css || !p.fonts.empty()) && asset_dir(css_href_prefix_, dir)) {
+            if (linked_css) note(write_asset(dir, prune_css_ ? make_asset(css_stem(), "css", p.pruned_css) : stylesheet(), options));
+            for (const Asset& font : p.fonts) note(write_asset(dir, font, options));
+        }
+        std::vector<Asset> js = scripts();
+        if (!js.empty() && asset_dir(script_href_prefix_, dir)) {
+            for (const Asset& script : js) note(write_asset(dir, script, options));
+        }
+        if (!result) return result;
+
+        SegmentSink out;
+        render_document(out, p);
+        BuildManifest* manifest = options.manifest;
+        uint64_t hash = fnv1a64(std::string_view());
+        if (manifest)
+        {
+            // Hashed segment by segment, so the page is never copied
+            for (const iovec& v : out.segments()) hash = fnv1a64({static_cast<const char*>(v.iov_base), v.iov_len}, hash);
+            if (manifest->matches(path, hash) && precompressed_present(path, options.precompress))
+            {
+                result.unchanged = true;
+                if (options.committed) options.committed(result);
+                return result;
+            }
+        }
+        // Compressed from the same segments before the write consumes them,
+        // but only staged: the copies are renamed into place after the page,
+        // and dropped if the page cannot be
+        std::vector<StagedFile> files(1);
+        WriteResult siblings = stage_precompressed(path, out.segments().data(), out.segments().size(),
+                                                   options.precompress, files);
+
+        // The hash is recorded only once the page is in place, so a page
+        // whose write or batched rename fails is written again next time
+        auto done = [manifest, path, hash, siblings, committed = options.committed](WriteResult page) {
+            if (page) page = siblings;
+            if (manifest && page) manifest->record(path, hash);
+            else if (manifest) manifest->forget(path);
+            if (committed) committed(page);
+        };
+        WriteResult page = output_detail::stage(path, [&out](int fd) {
+            return out.flush(fd) ? 0 : out.error();
+        }, files.front());
+        if (page && options.batch)
+        {
+            options.batch->add(std::move(files), done);
+            note(siblings);
+            return result;
+        }
+        if (page) page = output_detail::publish(files.front(), options.sync);
+        for (size_t i = 1; i < files.size(); ++i)
+        {
+            if (!page)
+            {
+                output_detail::discard(files[i]);
+                continue;
+            }
+            WriteResult written = output_detail::publish(files[i], options.sync);
+            if (siblings && !written) siblings = written;
+        }
+        done(page ? siblings : page);
+        note(page);
+        note(siblings);
+        return result;
+    }
+
+    inline WriteResult Page::render_to_file(const std::string& path, const WriteOptions& options) const
+    {
+        return write_files(path, options);
+    }
+
+    inline WriteResult Page::render_to_file(const std::string& path, SyncPolicy policy) const
     {
-        mode = ThemeMode::Light;
+        WriteOptions options;
+        options.sync = policy;
+        return write_files(path, options);
     }
-    else if (theme_mode_ == 2)
+
+    inline WriteResult Page::render_to_file(const std::string& path, SyncBatch& batch) const
     {
-         mode = ThemeMode::Cream;
+        WriteOptions options;
+        options.batch = &batch;
+        return write_files(path, options);
     }
 
-    return render_page_html(title_, render_children(children_), include_htmx_, mode, include_sse_);
+    inline WriteResult Page::render_to_file(const std::string& path, BuildManifest& manifest, SyncPolicy policy) const
+    {
+        WriteOptions options;
+        options.sync = policy;
+        options.manifest = &manifest;
+        return write_files(path, options);
     }
 
-    inline void Page::render_to_file(const std::string& path) const 
+    inline WriteResult Page::render_to_file(const std::string& path, BuildManifest& manifest, SyncBatch& batch) const
     {
-        write_to_file(path, render());
+        WriteOptions options;
+        options.batch = &batch;
+        options.manifest = &manifest;
+        return write_files(path, options);
     }
 
 }
\ No newline at end of file